@@ -0,0 +1,85 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include "mapped_file.h"
+
+// Pre-converted asset pack (.pak), written offline by tools/assetpack.cpp. Payloads are
+// already in the form the game uploads: RGBA32 pixels, PCM in the mixer's output format,
+// and glyph atlases rasterised per font size. A name-sorted index sits at the end, so the
+// game maps the file once and hands out pointers into it.
+namespace assetpack {
+
+constexpr char     kMagic[8]  = { 'M','O','K','I','P','A','K','\0' };
+constexpr uint32_t kVersion   = 1;
+constexpr uint32_t kEndianTag = 0x01020304u;
+constexpr uint64_t kAlign     = 16;
+
+enum Kind : uint32_t { KindImage, KindAnimation, KindSound, KindGlyphs };
+
+struct Header {
+  char     magic[8];
+  uint32_t version, endianTag;
+  uint32_t entryCount, reserved;
+  uint64_t indexOffset, fileSize;
+};
+
+// Image:     w x h RGBA32, pitch w*4.
+// Animation: `count` int32 frame delays (ms), padded to kAlign, then `count` w x h RGBA32 frames.
+// Sound:     PCM; w = SDL audio format, h = channels, param = frequency.
+// Glyphs:    256 GlyphRec (Latin-1, like TTF_RenderText), padded to kAlign, then a w x h RGBA32
+//            atlas of white glyphs; param = line height. Named "<font path>@<point size>".
+struct Entry {
+  char     name[96];
+  uint32_t kind, flags;
+  uint64_t offset, size;
+  uint32_t w, h, count, param;
+};
+struct GlyphRec { int16_t x, y, w, h, advance, pad; };
+
+static_assert(sizeof(Header) == 40 && sizeof(Entry) == 136 && sizeof(GlyphRec) == 12, "asset pack layout");
+
+constexpr uint64_t align(uint64_t v) { return (v + kAlign - 1) & ~(kAlign - 1); }
+inline std::string glyphName(const std::string& font, int ptsize) { return font + "@" + std::to_string(ptsize); }
+
+class Pack {
+public:
+  bool open(const std::string& path, std::string* err=nullptr) {
+    auto fail = [&](const char* why){ if (err) *err = why; file.close(); hdr = nullptr; index = nullptr; return false; };
+    if (!file.open(path)) return fail("cannot open file");
+    if (file.size() < sizeof(Header)) return fail("truncated header");
+    hdr = (const Header*)file.data();
+    if (std::memcmp(hdr->magic, kMagic, sizeof(kMagic)) != 0) return fail("bad magic");
+    if (hdr->endianTag != kEndianTag) return fail("endianness mismatch");
+    if (hdr->version != kVersion) return fail("unsupported version");
+    if (hdr->fileSize > file.size() || (hdr->indexOffset & 7) != 0 || hdr->indexOffset > file.size()
+        || hdr->entryCount > (file.size() - hdr->indexOffset) / sizeof(Entry)) return fail("bad index");
+    index = (const Entry*)(file.data() + hdr->indexOffset);
+    for (uint32_t i = 0; i < hdr->entryCount; ++i) {
+      const Entry& e = index[i];
+      if (e.name[sizeof(e.name) - 1] != '\0' || e.offset > file.size() || e.size > file.size() - e.offset) return fail("entry out of bounds");
+    }
+    return true;
+  }
+
+  const Entry* find(const std::string& name, Kind kind) const {
+    if (!index) return nullptr;
+    const Entry* end = index + hdr->entryCount;
+    const Entry* it = std::lower_bound(index, end, name, [](const Entry& e, const std::string& n){ return std::strcmp(e.name, n.c_str()) < 0; });
+    return (it != end && name == it->name && it->kind == kind) ? it : nullptr;
+  }
+  const uint8_t* data(const Entry& e) const { return file.data() + e.offset; }
+
+  bool isOpen() const { return index != nullptr; }
+  bool isMapped() const { return file.isMapped(); }
+  uint32_t entryCount() const { return hdr ? hdr->entryCount : 0; }
+  size_t bytes() const { return file.size(); }
+
+private:
+  MappedFile file;
+  const Header* hdr = nullptr;
+  const Entry* index = nullptr;
+};
+
+}
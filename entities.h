@@ -0,0 +1,128 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Handle to an entity row. The generation changes when the slot is reused, so a handle
+// kept past destroy() stops resolving instead of pointing at a newer entity.
+struct Entity {
+  uint32_t index{0xFFFFFFFFu}, generation{0};
+  bool operator==(const Entity& o) const { return index == o.index && generation == o.generation; }
+  bool operator!=(const Entity& o) const { return !(*this == o); }
+};
+
+// One archetype: every entity in it has exactly the components Cs, stored as parallel
+// dense columns. Rows stay packed and in spawn order; handles map to rows through a
+// slot table. Systems walk the columns they need with each<Q...>().
+template <class... Cs> class Archetype {
+public:
+  static_assert(sizeof...(Cs) > 0, "archetype needs at least one component");
+  template <class C> static constexpr bool has = (std::is_same_v<C, Cs> || ...);
+
+  Entity create(Cs... cs) {
+    uint32_t slot;
+    if (!freeSlots.empty()) { slot = freeSlots.back(); freeSlots.pop_back(); }
+    else { slot = uint32_t(slotRow.size()); slotRow.push_back(0); slotGen.push_back(0); }
+    slotRow[slot] = uint32_t(rowSlot.size());
+    rowSlot.push_back(slot);
+    (std::get<std::vector<Cs>>(cols).push_back(std::move(cs)), ...);
+    return Entity{ slot, slotGen[slot] };
+  }
+
+  bool alive(Entity e) const { return e.index < slotGen.size() && slotGen[e.index] == e.generation && slotRow[e.index] != kDead; }
+  size_t rowOf(Entity e) const { return slotRow[e.index]; }
+  Entity entityAt(size_t row) const { uint32_t s = rowSlot[row]; return Entity{ s, slotGen[s] }; }
+
+  template <class C> C& get(Entity e) { return column<C>()[slotRow[e.index]]; }
+  template <class C> std::vector<C>& column() { static_assert(has<C>, "component not in archetype"); return std::get<std::vector<C>>(cols); }
+  template <class C> const std::vector<C>& column() const { static_assert(has<C>, "component not in archetype"); return std::get<std::vector<C>>(cols); }
+
+  size_t size() const { return rowSlot.size(); }
+  bool empty() const { return rowSlot.empty(); }
+  void reserve(size_t n) { rowSlot.reserve(n); (std::get<std::vector<Cs>>(cols).reserve(n), ...); }
+
+  template <class... Q, class F> void each(F&& f) {
+    auto ptrs = std::make_tuple(column<Q>().data()...);
+    for (size_t i = 0, n = size(); i < n; ++i) f(std::get<Q*>(ptrs)[i]...);
+  }
+
+  void destroy(Entity e) {
+    if (!alive(e)) return;
+    size_t row = slotRow[e.index];
+    removeRows([row](size_t i){ return i == row; });
+  }
+
+  // Drops every row for which dead(row) is true in one order-preserving compaction pass.
+  template <class Pred> void removeRows(Pred&& dead) {
+    size_t n = size(), out = 0;
+    for (size_t i = 0; i < n; ++i) {
+      if (dead(i)) { uint32_t s = rowSlot[i]; slotRow[s] = kDead; slotGen[s]++; freeSlots.push_back(s); continue; }
+      if (out != i) { rowSlot[out] = rowSlot[i]; ((std::get<std::vector<Cs>>(cols)[out] = std::move(std::get<std::vector<Cs>>(cols)[i])), ...); }
+      slotRow[rowSlot[out]] = uint32_t(out); ++out;
+    }
+    if (out == n) return;
+    rowSlot.resize(out); (std::get<std::vector<Cs>>(cols).resize(out), ...);
+  }
+
+  // Drops every row. Slots and their generations are kept and bumped as in destroy(), so
+  // handles taken before the clear stop resolving instead of matching whatever reuses the slot.
+  void clear() {
+    for (uint32_t s : rowSlot) { slotRow[s] = kDead; slotGen[s]++; freeSlots.push_back(s); }
+    rowSlot.clear();
+    (std::get<std::vector<Cs>>(cols).clear(), ...);
+  }
+
+  // Raw column dump for rollback snapshots; components must be trivially copyable.
+  void save(std::vector<uint8_t>& out) const {
+    static_assert((std::is_trivially_copyable_v<Cs> && ...), "snapshot components must be memcpy-able");
+    putVec(out, rowSlot); putVec(out, slotRow); putVec(out, slotGen); putVec(out, freeSlots);
+    (putVec(out, std::get<std::vector<Cs>>(cols)), ...);
+  }
+  const uint8_t* load(const uint8_t* in) {
+    in = getVec(in, rowSlot); in = getVec(in, slotRow); in = getVec(in, slotGen); in = getVec(in, freeSlots);
+    ((in = getVec(in, std::get<std::vector<Cs>>(cols))), ...);
+    return in;
+  }
+
+private:
+  static constexpr uint32_t kDead = 0xFFFFFFFFu;
+  std::tuple<std::vector<Cs>...> cols;
+  std::vector<uint32_t> rowSlot, slotRow, slotGen, freeSlots;
+
+  template <class T> static void putVec(std::vector<uint8_t>& out, const std::vector<T>& v) {
+    uint64_t n = v.size(); size_t at = out.size();
+    out.resize(at + sizeof(n) + n * sizeof(T));
+    std::memcpy(out.data() + at, &n, sizeof(n));
+    if (n) std::memcpy(out.data() + at + sizeof(n), v.data(), n * sizeof(T));
+  }
+  template <class T> static const uint8_t* getVec(const uint8_t* in, std::vector<T>& v) {
+    uint64_t n; std::memcpy(&n, in, sizeof(n)); in += sizeof(n);
+    v.resize(size_t(n));
+    if (n) std::memcpy((void*)v.data(), in, size_t(n) * sizeof(T));
+    return in + n * sizeof(T);
+  }
+};
+
+// A fixed set of archetypes. each<Q...>() visits every archetype that has all of Q, so a
+// system written against components covers new entity types without another loop.
+template <class... As> class EntityStore {
+public:
+  template <class A> A& table() { return std::get<A>(tables); }
+  template <class A> const A& table() const { return std::get<A>(tables); }
+
+  template <class... Q, class F> void each(F&& f) { (visit<As, Q...>(f), ...); }
+
+  size_t size() const { return (std::get<As>(tables).size() + ... + 0); }
+  void clear() { (std::get<As>(tables).clear(), ...); }
+
+private:
+  std::tuple<As...> tables;
+
+  template <class A, class... Q, class F> void visit(F& f) {
+    if constexpr ((A::template has<Q> && ...)) std::get<A>(tables).template each<Q...>(f);
+  }
+};
@@ -3,16 +3,41 @@
 #include <SDL2/SDL_ttf.h>
 #include <SDL2/SDL_mixer.h>
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cmath>
+#include <condition_variable>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
+#include <deque>
+#include <filesystem>
+#include <functional>
 #include <iomanip>
 #include <iostream>
 #include <limits>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <new>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+#include "assetpack.h"
+#include "entities.h"
+#include "netplay.h"
+#include "statsshm.h"
+#include "worldfile.h"
 
 const int SCREEN_WIDTH  = 1360;
 const int SCREEN_HEIGHT = 1024;
@@ -43,6 +68,9 @@ int   AVOCADO_CONTACT_DMG   = 6;
 Uint32 AVOCADO_DMG_COOLDOWN = 300;
 Uint32 AVOCADO_SPLIT_SHOWMS = 650;
 
+float  SIM_LOD_FULL_DIST        = 1400.0f;
+Uint32 SIM_LOD_REDUCED_INTERVAL = 4;
+
 int    KNIFE_CLIP          = 3;
 bool   KNIFE_UNLIMITED     = false;
 float  KNIFE_SPEED         = 3.0f;
@@ -68,6 +96,59 @@ const std::string kSndSlice    = "game/assets/images/slice.mp3";
 const std::string kSndDeath    = "game/assets/images/lost_sound.mp3";
 const std::string kSndThrow    = "game/assets/images/throweffect.mp3";
 const std::string kSndWeb      = "game/assets/images/web.mp3";
+const std::string kWorldSave   = "game/saves/quick.mkw";
+const std::string kAssetPack   = "game/assets.pak";
+
+
+// Scratch directory for paged-out chunks. It is wiped on start and exit, so it is per process:
+// a second instance must not delete the first one's chunks.
+static std::string chunkDirForProcess() {
+#ifdef _WIN32
+  unsigned long pid = (unsigned long)_getpid();
+#else
+  unsigned long pid = (unsigned long)getpid();
+#endif
+  std::error_code ec;
+  std::filesystem::path base = std::filesystem::temp_directory_path(ec);
+  if (ec) base = "game/saves";
+  return (base / ("moki-chunks-" + std::to_string(pid))).string();
+}
+
+int    ATLAS_PAGE_SIZE  = 2048;
+int    ATLAS_PADDING    = 2;
+
+size_t WORLD_LOAD_BATCH = 32768;
+int    CHUNK_SIZE          = 2048;
+int    CHUNK_ACTIVE_MARGIN = 1;
+int    CHUNK_EVICT_MARGIN  = 3;
+
+int   AUDIO_CHANNELS       = 32;
+float AUDIO_MASTER_VOLUME  = 0.90f;
+float AUDIO_FALLOFF_START  = 900.0f;
+float AUDIO_CULL_DIST      = 2400.0f;
+
+int   PARTICLE_CAPACITY = 100000;
+float PARTICLE_GRAVITY  = 1400.0f;
+float PARTICLE_DRAG     = 1.8f;
+
+enum class Pacing { Vsync, Uncapped, Limit };
+Pacing FRAME_PACING        = Pacing::Vsync;
+int    FRAME_LIMIT_HZ      = 120;
+int    FRAME_LIMIT_SPIN_US = 1500;
+int    SIM_TICK_HZ         = 60;
+int    SIM_MAX_CATCHUP     = 5;
+int    ROLLBACK_WINDOW_MS  = 300;   // covers a peer's one-way latency plus jitter
+
+bool        STATS_EXPORT     = true;
+std::string STATS_SHM_NAME   = statsshm::kDefaultName;
+int         STATS_PUBLISH_MS = 100;
+
+bool  DRS_ENABLED   = true;
+float DRS_MIN_SCALE = 0.50f;
+float DRS_MAX_SCALE = 1.00f;
+float DRS_STEP      = 0.05f;
+float DRS_TARGET_MS = 16.67f;   // uncapped budget, and vsync's when the refresh rate is unknown
+int   DRS_UP_FRAMES = 60;
 
 const int  WEB_LOCK_ROW_1BASE = 3; 
 const int  WEB_LOCK_COL_1BASE = 8;   
@@ -78,12 +159,79 @@ float WEB_ANCHOR_U = 0.78f;
 float WEB_ANCHOR_V = 0.33f;  
 const bool WEB_ANCHOR_MIRROR = true;
 
-static void renderText(SDL_Renderer* r, TTF_Font* f, const std::string& text, int x, int y, SDL_Color col={255,255,255,255}) {
-  SDL_Surface* surf = TTF_RenderText_Blended(f, text.c_str(), col);
+// Render calls issued this frame, for the stats export. Every SDL draw goes through drawCall().
+static Uint32 gDrawCalls = 0;
+template <class F, class... A> static int drawCall(F fn, A... args) { ++gDrawCalls; return fn(args...); }
+
+// Global operator new is counted so the stats export can report allocations per frame.
+// Only the main thread counts (main() sets the flag); the chunk and loopback workers start
+// with it off, so their I/O doesn't show up as loop allocations. SDL's mallocs are not included.
+static thread_local bool tCountAllocs = false;
+static std::atomic<uint64_t> gAllocCount{0}, gAllocBytes{0};
+void* operator new(std::size_t n) {
+  if (tCountAllocs) { gAllocCount.fetch_add(1, std::memory_order_relaxed); gAllocBytes.fetch_add(n, std::memory_order_relaxed); }
+  if (void* p = std::malloc(n ? n : 1)) return p;
+  throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+static size_t textureBytes(SDL_Texture* t) {
+  Uint32 fmt = 0; int w = 0, h = 0;
+  if (!t || SDL_QueryTexture(t, &fmt, nullptr, &w, &h) != 0) return 0;
+  return size_t(w) * size_t(h) * std::max<size_t>(1, SDL_BYTESPERPIXEL(fmt));
+}
+
+// A HUD font: either a live TTF_Font or a glyph atlas baked into the asset pack. The packed
+// path draws per-glyph copies from one texture instead of rasterising a surface every call.
+struct TextFont {
+  TTF_Font* ttf{};
+  SDL_Texture* glyphTex{};
+  const assetpack::GlyphRec* glyphs{};
+  int lineH{0};
+
+  bool open(SDL_Renderer* ren, const assetpack::Pack& pack, const std::string& path, int ptsize) {
+    if (const assetpack::Entry* e = pack.find(assetpack::glyphName(path, ptsize), assetpack::KindGlyphs)) {
+      const uint8_t* p = pack.data(*e);
+      uint64_t recBytes = assetpack::align(256 * sizeof(assetpack::GlyphRec));
+      if (e->count == 256 && e->size >= recBytes + uint64_t(e->w) * e->h * 4) {
+        glyphTex = SDL_CreateTexture(ren, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, int(e->w), int(e->h));
+        if (glyphTex && SDL_UpdateTexture(glyphTex, nullptr, p + recBytes, int(e->w) * 4) == 0) {
+          SDL_SetTextureBlendMode(glyphTex, SDL_BLENDMODE_BLEND);
+          glyphs = (const assetpack::GlyphRec*)p; lineH = int(e->param);
+          return true;
+        }
+        if (glyphTex) { SDL_DestroyTexture(glyphTex); glyphTex = nullptr; }
+      }
+    }
+    ttf = TTF_OpenFont(path.c_str(), ptsize);
+    return ttf != nullptr;
+  }
+  void close() {
+    if (ttf) TTF_CloseFont(ttf);
+    if (glyphTex) SDL_DestroyTexture(glyphTex);
+    ttf = nullptr; glyphTex = nullptr; glyphs = nullptr;
+  }
+  explicit operator bool() const { return ttf || glyphTex; }
+  size_t textureBytes() const { return ::textureBytes(glyphTex); }
+};
+
+static void renderText(SDL_Renderer* r, const TextFont& f, const std::string& text, int x, int y, SDL_Color col={255,255,255,255}) {
+  if (f.glyphTex) {
+    SDL_SetTextureColorMod(f.glyphTex, col.r, col.g, col.b); SDL_SetTextureAlphaMod(f.glyphTex, col.a);
+    for (unsigned char c : text) {
+      const assetpack::GlyphRec& g = f.glyphs[c];
+      if (g.w > 0 && g.h > 0) { SDL_Rect src{ g.x, g.y, g.w, g.h }, dst{ x, y, g.w, g.h }; drawCall(SDL_RenderCopy, r, f.glyphTex, &src, &dst); }
+      x += g.advance;
+    }
+    return;
+  }
+  if (!f.ttf) return;
+  SDL_Surface* surf = TTF_RenderText_Blended(f.ttf, text.c_str(), col);
   if (!surf) return;
   SDL_Texture* tex = SDL_CreateTextureFromSurface(r, surf);
   SDL_Rect dst{ x, y, surf->w, surf->h };
-  SDL_RenderCopy(r, tex, nullptr, &dst);
+  drawCall(SDL_RenderCopy, r, tex, nullptr, &dst);
   SDL_FreeSurface(surf);
   SDL_DestroyTexture(tex);
 }
@@ -104,6 +252,29 @@ public:
   float scale = 1.0f;
   bool loaded = false;
 
+  // Uploads pre-decoded frames straight from the pack; false sends the caller to load().
+  bool loadPacked(SDL_Renderer* ren, const assetpack::Pack& pack, const std::string& path) {
+    const assetpack::Entry* e = pack.find(path, assetpack::KindAnimation);
+    if (!e || e->count == 0) return false;
+    uint64_t frameBytes = uint64_t(e->w) * e->h * 4, delayBytes = assetpack::align(e->count * sizeof(int32_t));
+    if (e->size < delayBytes + frameBytes * e->count) return false;
+    const uint8_t* p = pack.data(*e);
+    frames.reserve(e->count);
+    for (uint32_t i = 0; i < e->count; ++i) {
+      SDL_Texture* t = SDL_CreateTexture(ren, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, int(e->w), int(e->h));
+      if (!t) continue;
+      SDL_UpdateTexture(t, nullptr, p + delayBytes + frameBytes * i, int(e->w) * 4);
+      SDL_SetTextureBlendMode(t, SDL_BLENDMODE_BLEND);
+      int32_t raw; std::memcpy(&raw, p + i * sizeof(int32_t), sizeof(raw));
+      AnimFrame f; f.tex = t; f.w = int(e->w); f.h = int(e->h);
+      f.delay_ms = std::max(10, std::min(2000, raw <= 0 ? 10 : int(raw)));
+      frames.push_back(f);
+    }
+    loaded = !frames.empty();
+    lastTick = SDL_GetTicks();
+    return loaded;
+  }
+
   bool load(SDL_Renderer* ren, const std::string& path) {
 #if SDL_IMAGE_VERSION_ATLEAST(2,6,0)
     if (IMG_Animation* a = IMG_LoadAnimation(path.c_str())) {
@@ -149,12 +320,17 @@ public:
     }
     for (int y = originY; y < screenH; y += th)
       for (int x = originX; x < screenW; x += tw) {
-        SDL_Rect dst{ x, y, tw, th }; SDL_RenderCopy(ren, f.tex, nullptr, &dst);
+        SDL_Rect dst{ x, y, tw, th }; drawCall(SDL_RenderCopy, ren, f.tex, nullptr, &dst);
       }
   }
   void setParallax(bool on) { parallax = on; }
   void addScale(float d)    { scale = std::max(0.05f, scale + d); }
   void resetScale()         { scale = 1.0f; }
+  size_t textureBytes() const {
+    size_t b = ::textureBytes(frameStatic.tex);
+    for (const auto& f : frames) b += ::textureBytes(f.tex);
+    return b;
+  }
 private:
   SDL_Renderer* renderer{};
   std::vector<AnimFrame> frames;
@@ -170,15 +346,175 @@ private:
   }
 };
 
+// A sprite's place in the atlas: the page texture plus the sub-rect to sample.
+struct AtlasRegion {
+  SDL_Texture* tex{};
+  SDL_Rect src{0,0,0,0};
+};
+
+// Skyline bin packer for one atlas page. Keeps the top edge of the packed area as a
+// list of segments and places each rect at the lowest position it fits (bottom-left).
+class SkylinePacker {
+public:
+  SkylinePacker(int w, int h) : W(w), H(h) { sky.push_back({0, 0, w}); }
+
+  bool insert(int w, int h, SDL_Point& out) {
+    int best = -1, bestY = H, bestX = W;
+    for (size_t i = 0; i < sky.size(); ++i) {
+      int y = fitAt(i, w, h);
+      if (y >= 0 && (y < bestY || (y == bestY && sky[i].x < bestX))) { best = (int)i; bestY = y; bestX = sky[i].x; }
+    }
+    if (best < 0) return false;
+    out = { bestX, bestY };
+    Seg seg{ bestX, bestY + h, w };
+    sky.insert(sky.begin() + best, seg);
+    for (size_t i = best + 1; i < sky.size(); ) {
+      int prevEnd = sky[i-1].x + sky[i-1].w;
+      if (sky[i].x >= prevEnd) break;
+      int shrink = prevEnd - sky[i].x;
+      sky[i].x += shrink; sky[i].w -= shrink;
+      if (sky[i].w <= 0) sky.erase(sky.begin() + i); else break;
+    }
+    for (size_t i = 0; i + 1 < sky.size(); ) {
+      if (sky[i].y == sky[i+1].y) { sky[i].w += sky[i+1].w; sky.erase(sky.begin() + i + 1); } else ++i;
+    }
+    used += (long long)w * h;
+    return true;
+  }
+  float occupancy() const { return float(used) / float((long long)W * H); }
+
+private:
+  struct Seg { int x, y, w; };
+  int W, H; long long used = 0;
+  std::vector<Seg> sky;
+
+  int fitAt(size_t i, int w, int h) const {
+    int x = sky[i].x; if (x + w > W) return -1;
+    int y = 0, left = w;
+    for (size_t j = i; left > 0; ++j) {
+      if (j >= sky.size()) return -1;
+      y = std::max(y, sky[j].y);
+      if (y + h > H) return -1;
+      left -= sky[j].w;
+    }
+    return y;
+  }
+};
+
+// Packs small sprites into a few ATLAS_PAGE_SIZE pages so a frame of entities is drawn
+// from one texture. add() queues surfaces for the startup build(); insert() places a
+// surface into a live page afterwards (runtime-generated platform textures). Anything
+// larger than a page gets a standalone texture the atlas still owns, so every id resolves.
+class TextureAtlas {
+public:
+  ~TextureAtlas() { destroy(); }
+
+  int add(SDL_Surface* s) {
+    SDL_Surface* c = s ? SDL_ConvertSurfaceFormat(s, SDL_PIXELFORMAT_RGBA32, 0) : nullptr;
+    regions.push_back(AtlasRegion{});
+    queued.push_back({ (int)regions.size() - 1, c });
+    return (int)regions.size() - 1;
+  }
+
+  void build(SDL_Renderer* ren) {
+    std::stable_sort(queued.begin(), queued.end(), [](const Pending& a, const Pending& b){
+      return (a.surf ? a.surf->h : 0) > (b.surf ? b.surf->h : 0);
+    });
+    for (auto& q : queued) {
+      if (!q.surf) continue;
+      regions[q.id] = place(ren, q.surf);
+      if (!regions[q.id].tex) std::cerr << "atlas: could not place " << q.surf->w << "x" << q.surf->h << " image " << q.id << "\n";
+      SDL_FreeSurface(q.surf);
+    }
+    queued.clear();
+  }
+
+  int insert(SDL_Renderer* ren, SDL_Surface* s) {
+    SDL_Surface* c = s ? SDL_ConvertSurfaceFormat(s, SDL_PIXELFORMAT_RGBA32, 0) : nullptr;
+    regions.push_back(c ? place(ren, c) : AtlasRegion{});
+    if (c) SDL_FreeSurface(c);
+    return regions.size() && regions.back().tex ? (int)regions.size() - 1 : -1;
+  }
+
+  AtlasRegion region(int id) const { return (id >= 0 && id < (int)regions.size()) ? regions[id] : AtlasRegion{}; }
+  int pageCount() const { return (int)pages.size(); }
+  int standaloneCount() const { return (int)singles.size(); }
+  size_t pageBytes() const { size_t b = 0; for (const auto& p : pages) b += ::textureBytes(p.tex); return b; }
+  size_t standaloneBytes() const { size_t b = 0; for (SDL_Texture* t : singles) b += ::textureBytes(t); return b; }
+  int spriteCount() const { return (int)regions.size(); }
+  float occupancy() const {
+    float sum = 0.f; for (const auto& p : pages) sum += p.packer.occupancy();
+    return pages.empty() ? 0.f : sum / pages.size();
+  }
+
+  void destroy() {
+    for (auto& q : queued) if (q.surf) SDL_FreeSurface(q.surf);
+    for (auto& p : pages) if (p.tex) SDL_DestroyTexture(p.tex);
+    for (SDL_Texture* t : singles) SDL_DestroyTexture(t);
+    queued.clear(); pages.clear(); regions.clear(); singles.clear();
+  }
+
+private:
+  struct Page { SDL_Texture* tex; SkylinePacker packer; };
+  struct Pending { int id; SDL_Surface* surf; };
+  std::vector<Page> pages;
+  std::vector<AtlasRegion> regions;
+  std::vector<Pending> queued;
+  std::vector<SDL_Texture*> singles;
+
+  AtlasRegion place(SDL_Renderer* ren, SDL_Surface* s) {
+    int w = s->w + ATLAS_PADDING, h = s->h + ATLAS_PADDING;
+    if (w > ATLAS_PAGE_SIZE || h > ATLAS_PAGE_SIZE) {
+      SDL_Texture* t = SDL_CreateTextureFromSurface(ren, s);
+      if (!t) { std::cerr << "atlas standalone " << s->w << "x" << s->h << ": " << SDL_GetError() << "\n"; return AtlasRegion{}; }
+      SDL_SetTextureBlendMode(t, SDL_BLENDMODE_BLEND); singles.push_back(t);
+      return AtlasRegion{ t, { 0, 0, s->w, s->h } };
+    }
+    SDL_Point at{};
+    Page* page = nullptr;
+    for (auto& p : pages) if (p.packer.insert(w, h, at)) { page = &p; break; }
+    if (!page) {
+      SDL_Texture* t = SDL_CreateTexture(ren, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE);
+      if (!t) { std::cerr << "atlas page: " << SDL_GetError() << "\n"; return AtlasRegion{}; }
+      std::vector<Uint32> clear(size_t(ATLAS_PAGE_SIZE) * ATLAS_PAGE_SIZE, 0u);
+      SDL_UpdateTexture(t, nullptr, clear.data(), ATLAS_PAGE_SIZE * 4);
+      SDL_SetTextureBlendMode(t, SDL_BLENDMODE_BLEND);
+      pages.push_back({ t, SkylinePacker(ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE) });
+      page = &pages.back();
+      if (!page->packer.insert(w, h, at)) return AtlasRegion{};
+    }
+    SDL_Rect dst{ at.x, at.y, s->w, s->h };
+    SDL_LockSurface(s); SDL_UpdateTexture(page->tex, &dst, s->pixels, s->pitch); SDL_UnlockSurface(s);
+    return AtlasRegion{ page->tex, dst };
+  }
+};
+
 struct Tile {
   SDL_Rect rect;
   SDL_Texture* texture{};
   SDL_Color glowColor{0,0,0,0};
   bool isDynamic{false};
   Uint32 glowUntilMS{0};
+  SDL_Rect src{0,0,0,0};
 };
 
-static SDL_Texture* makeNeonTexture(SDL_Renderer* r, int w, int h, SDL_Color baseBg, SDL_Color line1, SDL_Color line2) {
+// Shrinks an image to the size it is drawn at, so large source art doesn't cost atlas space. New RGBA32 surface, or nullptr.
+static SDL_Surface* scaledSurface(SDL_Surface* src, float scale) {
+  SDL_Surface* c = SDL_ConvertSurfaceFormat(src, SDL_PIXELFORMAT_RGBA32, 0);
+  SDL_Surface* d = c ? SDL_CreateRGBSurfaceWithFormat(0, std::max(1, int(src->w * scale)), std::max(1, int(src->h * scale)), 32, SDL_PIXELFORMAT_RGBA32) : nullptr;
+  if (d) {
+#if SDL_VERSION_ATLEAST(2,0,16)
+    bool ok = SDL_SoftStretchLinear(c, nullptr, d, nullptr) == 0;
+#else
+    bool ok = false;
+#endif
+    if (!ok) { SDL_SetSurfaceBlendMode(c, SDL_BLENDMODE_NONE); if (SDL_BlitScaled(c, nullptr, d, nullptr) != 0) { SDL_FreeSurface(d); d = nullptr; } }
+  }
+  SDL_FreeSurface(c);
+  return d;
+}
+
+static SDL_Surface* makeNeonSurface(int w, int h, SDL_Color baseBg, SDL_Color line1, SDL_Color line2) {
   SDL_Surface* s = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_RGBA32);
   if (!s) return nullptr;
   SDL_FillRect(s, nullptr, SDL_MapRGBA(s->format, baseBg.r, baseBg.g, baseBg.b, 255));
@@ -197,10 +533,7 @@ static SDL_Texture* makeNeonTexture(SDL_Renderer* r, int w, int h, SDL_Color bas
     for (int x=0; x<w; ++x) if (hLine || (x % cell) == 0)
       row[x] = SDL_MapRGBA(s->format, line1.r, line1.g, line1.b, 255);
   }
-  SDL_Texture* tex = SDL_CreateTextureFromSurface(r, s);
-  SDL_FreeSurface(s);
-  SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
-  return tex;
+  return s;
 }
 static void renderGlowRect(SDL_Renderer* ren, const SDL_Rect& worldRect, int camX, int camY, SDL_Color color, float pulse01) {
   Uint8 baseA = Uint8(120 + 135*pulse01);
@@ -208,7 +541,7 @@ static void renderGlowRect(SDL_Renderer* ren, const SDL_Rect& worldRect, int cam
   for (int i=0; i<5; ++i) {
     SDL_Rect rr{ worldRect.x - camX - i*3, worldRect.y - camY - i*3, worldRect.w + i*6, worldRect.h + i*6 };
     Uint8 a = Uint8(std::max(0, int(baseA) - i*20));
-    SDL_SetRenderDrawColor(ren, color.r, color.g, color.b, a); SDL_RenderDrawRect(ren, &rr);
+    SDL_SetRenderDrawColor(ren, color.r, color.g, color.b, a); drawCall(SDL_RenderDrawRect, ren, &rr);
   }
   SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_BLEND);
 }
@@ -223,10 +556,18 @@ public:
     if (!surf) throw std::runtime_error(std::string("IMG_Load: ") + IMG_GetError());
     texture.reset(SDL_CreateTextureFromSurface(ren, surf)); SDL_FreeSurface(surf);
     int imgW, imgH; SDL_QueryTexture(texture.get(), nullptr, nullptr, &imgW, &imgH);
+    sheet = AtlasRegion{ texture.get(), { 0, 0, imgW, imgH } };
     frameW = imgW / cols; frameH = imgH / rows;
     dst.w = int(frameW * scale); dst.h = int(frameH * scale);
     updateCrop();
   }
+  Sprite(SDL_Renderer* ren, const AtlasRegion& sheetRegion, int rows=3, int cols=8)
+  : renderer(ren), sheet(sheetRegion), rows(rows), cols(cols) {
+    if (!sheet.tex) throw std::runtime_error("Sprite: empty atlas region");
+    frameW = sheet.src.w / cols; frameH = sheet.src.h / rows;
+    dst.w = int(frameW * scale); dst.h = int(frameH * scale);
+    updateCrop();
+  }
 
   void setWebAnchorUV(float u, float v, bool mirror=true) {
     webU = clampf(u, 0.f, 1.f); webV = clampf(v, 0.f, 1.f); webMirror = mirror;
@@ -245,18 +586,18 @@ public:
 
   void placeOnTopOf(int tileTop) { y = (float)tileTop - dst.h; }
 
-  int handleInput(const Uint8* keys, const std::vector<Tile>& tiles, bool inputEnabled) {
+  int handleInput(int moveDir, const std::vector<SDL_Rect>& colliders, bool inputEnabled, Uint32 nowMS) {
     float dx = 0.0f;
-    if (inputEnabled) { if (keys[SDL_SCANCODE_A]) dx = -1.0f; if (keys[SDL_SCANCODE_D]) dx = +1.0f; }
+    if (inputEnabled) dx = float(moveDir);
     x += dx * speed; if (dx < 0) facing = SDL_FLIP_HORIZONTAL; else if (dx > 0) facing = SDL_FLIP_NONE;
 
     if (frameLock) {
       currentRow = lockRow; currentFrame = lockCol; updateCrop();
-    } else if (throwPoseUntilMS && SDL_GetTicks() < throwPoseUntilMS) {
+    } else if (throwPoseUntilMS && nowMS < throwPoseUntilMS) {
       currentRow = throwPoseRow; currentFrame = throwPoseCol; updateCrop();
     } else {
       throwPoseUntilMS = 0;
-      (dx != 0) ? playAnim(0, 7, 2, 100) : idle(120);
+      (dx != 0) ? playAnim(0, 7, 2, 100, nowMS) : idle(120, nowMS);
     }
 
     const float g = MOON_MODE ? GRAVITY_MOON : GRAVITY_NORMAL;
@@ -269,19 +610,19 @@ public:
     SDL_Rect cNow = collisionRect(); float nowBottom = cNow.y + cNow.h;
     bool landed = false; int bestTop = std::numeric_limits<int>::min(), landedIndex = -1;
 
-    for (size_t i=0; i<tiles.size(); ++i) {
-      const auto& t = tiles[i];
-      if (!((cNow.x + cNow.w > t.rect.x) && (cNow.x < t.rect.x + t.rect.w))) continue;
+    for (size_t i=0; i<colliders.size(); ++i) {
+      const SDL_Rect& t = colliders[i];
+      if (!((cNow.x + cNow.w > t.x) && (cNow.x < t.x + t.w))) continue;
       if (velY >= 0.0f) {
-        if (prevBottom <= t.rect.y + EPS && nowBottom >= t.rect.y - EPS) {
+        if (prevBottom <= t.y + EPS && nowBottom >= t.y - EPS) {
           if ((nowBottom - prevBottom) <= (MAX_STEP + std::max(0.0f, velY))) {
-            if (t.rect.y > bestTop) { bestTop = t.rect.y; landed = true; landedIndex = (int)i; }
+            if (t.y > bestTop) { bestTop = t.y; landed = true; landedIndex = (int)i; }
           }
         }
       }
     }
     if (landed) { y = (float)bestTop - (float)(collisionRect().h + HITBOX_SHRINK_Y); velY = 0.0f; onGround = true; jumpCount = 0; flipping = false; flipAngle = 0.0; }
-    updateFlip();
+    updateFlip(nowMS);
     return landedIndex;
   }
 
@@ -294,47 +635,51 @@ public:
     SDL_Rect dstR = dst; dstR.x = (int)(x - camX); dstR.y = (int)(y - camY);
     SDL_Point center{ dstR.w / 2, dstR.h / 2 };
     double angle = dead ? 90.0 : (flipping ? (flipSign * flipAngle) : 0.0);
-    SDL_RenderCopyEx(r, texture.get(), &crop, &dstR, angle, &center, facing);
+    bool tinted = (tint.r != 255 || tint.g != 255 || tint.b != 255);
+    if (tinted) SDL_SetTextureColorMod(sheet.tex, tint.r, tint.g, tint.b);
+    drawCall(SDL_RenderCopyEx, r, sheet.tex, &crop, &dstR, angle, &center, facing);
+    if (tinted) SDL_SetTextureColorMod(sheet.tex, 255, 255, 255);
     if (debug) {
       SDL_Rect outer = interactionRect(); SDL_Rect outerScr{ outer.x - camX, outer.y - camY, outer.w, outer.h };
-      SDL_SetRenderDrawColor(r, 255, 40, 40, 200); SDL_RenderDrawRect(r, &outerScr);
+      SDL_SetRenderDrawColor(r, 255, 40, 40, 200); drawCall(SDL_RenderDrawRect, r, &outerScr);
       SDL_Rect c = collisionRect(); SDL_Rect cScr{ c.x - camX, c.y - camY, c.w, c.h };
-      SDL_SetRenderDrawColor(r, 0, 220, 255, 220); SDL_RenderDrawRect(r, &cScr);
+      SDL_SetRenderDrawColor(r, 0, 220, 255, 220); drawCall(SDL_RenderDrawRect, r, &cScr);
       // draw small cross at web anchor
       SDL_FPoint wa = webAnchorWorld();
       int ax = int(wa.x) - camX, ay = int(wa.y) - camY;
       SDL_SetRenderDrawColor(r, 255, 255, 0, 200);
-      SDL_RenderDrawLine(r, ax-4, ay, ax+4, ay);
-      SDL_RenderDrawLine(r, ax, ay-4, ax, ay+4);
+      drawCall(SDL_RenderDrawLine, r, ax-4, ay, ax+4, ay);
+      drawCall(SDL_RenderDrawLine, r, ax, ay-4, ax, ay+4);
     }
   }
 
-  void playAnim(int f, int l, int r, float speedMS) {
+  // Timed state takes the sim clock (TickClock::nowMS) rather than SDL_GetTicks, so a rollback replay matches.
+  void playAnim(int f, int l, int r, float speedMS, Uint32 nowMS) {
     if (frameLock) return;
     firstFrame = f; lastFrame = l; currentRow = r;
-    if (SDL_GetTicks() - lastAnimTick >= (Uint32)speedMS) { currentFrame = (currentFrame + 1 > lastFrame) ? firstFrame : currentFrame + 1; updateCrop(); lastAnimTick = SDL_GetTicks(); }
+    if (nowMS - lastAnimTick >= (Uint32)speedMS) { currentFrame = (currentFrame + 1 > lastFrame) ? firstFrame : currentFrame + 1; updateCrop(); lastAnimTick = nowMS; }
   }
-  void idle(float speedMS) {
+  void idle(float speedMS, Uint32 nowMS) {
     if (frameLock) return;
-    if (SDL_GetTicks() - lastIdleTick >= (Uint32)speedMS) { currentRow = 0; currentFrame = (currentFrame + 1) % cols; updateCrop(); lastIdleTick = SDL_GetTicks(); }
+    if (nowMS - lastIdleTick >= (Uint32)speedMS) { currentRow = 0; currentFrame = (currentFrame + 1) % cols; updateCrop(); lastIdleTick = nowMS; }
   }
 
-  void startFlip(FlipType type, bool inputEnabled) {
+  void startFlip(FlipType type, bool inputEnabled, Uint32 nowMS) {
     if (!inputEnabled) return; if (onGround || flipping) return;
-    flipping = true; flipType = type; flipAngle = 0.0; flipStartMS = SDL_GetTicks();
+    flipping = true; flipType = type; flipAngle = 0.0; flipStartMS = nowMS;
     bool facingLeft = (facing == SDL_FLIP_HORIZONTAL);
     if (type == FlipType::Back)  flipSign = facingLeft ? +1 : -1; else flipSign = facingLeft ? -1 : +1;
   }
-  void updateFlip() {
+  void updateFlip(Uint32 nowMS) {
     if (!flipping) return; double dur = 600.0;
-    double t = (SDL_GetTicks() - flipStartMS) / dur;
+    double t = (nowMS - flipStartMS) / dur;
     if (t >= 1.0) { flipping = false; flipAngle = 0.0; flipType = FlipType::None; return; }
     double eased = 0.5 - 0.5 * std::cos(t * M_PI); flipAngle = 360.0 * eased;
   }
 
-  void triggerThrowPose(Uint32 holdMS = THROW_POSE_MS) {
+  void triggerThrowPose(Uint32 nowMS, Uint32 holdMS = THROW_POSE_MS) {
     if (frameLock) return; 
-    throwPoseUntilMS = SDL_GetTicks() + holdMS; currentRow = throwPoseRow; currentFrame = throwPoseCol; updateCrop();
+    throwPoseUntilMS = nowMS + holdMS; currentRow = throwPoseRow; currentFrame = throwPoseCol; updateCrop();
   }
 
   void setFrameLock(bool on, int row=WEB_LOCK_ROW, int col=WEB_LOCK_COL) {
@@ -373,6 +718,21 @@ public:
   void  addVel(float dx, float dy){ velX += dx; velY += dy; }
   float getVelX() const { return velX; }
 
+  struct PhysState {
+    float x, y, velX, velY; int jumpCount; bool onGround; SDL_RendererFlip facing;
+    bool flipping{false}; double flipAngle{0.0}; Uint32 flipStartMS{0}; int flipSign{-1}; FlipType flipType{FlipType::None};
+    bool frameLock{false}; Uint32 throwPoseUntilMS{0};
+  };
+  PhysState physState() const {
+    return { x, y, velX, velY, jumpCount, onGround, facing, flipping, flipAngle, flipStartMS, flipSign, flipType, frameLock, throwPoseUntilMS };
+  }
+  void setPhysState(const PhysState& s) {
+    x = s.x; y = s.y; velX = s.velX; velY = s.velY; jumpCount = s.jumpCount; onGround = s.onGround; facing = s.facing;
+    flipping = s.flipping; flipAngle = s.flipAngle; flipStartMS = s.flipStartMS; flipSign = s.flipSign; flipType = s.flipType;
+    throwPoseUntilMS = s.throwPoseUntilMS; setFrameLock(s.frameLock, lockRow, lockCol);
+  }
+  void setTint(Uint8 r, Uint8 g, Uint8 b) { tint = SDL_Color{ r, g, b, 255 }; }
+
   void hardResetPosition(int tileTop) {
     flipping = false; flipAngle = 0.0; flipType = FlipType::None;
     velX = 0.0f; velY = 0.0f; onGround = false; jumpCount = 0;
@@ -383,6 +743,8 @@ public:
 private:
   std::unique_ptr<SDL_Texture, void(*)(SDL_Texture*)> texture{nullptr, SDL_DestroyTexture};
   SDL_Renderer* renderer{};
+  AtlasRegion sheet;
+  SDL_Color tint{255,255,255,255};
   SDL_Rect crop{}, dst{};
   int frameW{}, frameH{}, rows = 3, cols = 8;
   int currentFrame = 0, firstFrame = 0, lastFrame = 7, currentRow = 0;
@@ -401,18 +763,278 @@ private:
 
   float webU = WEB_ANCHOR_U, webV = WEB_ANCHOR_V; bool webMirror = WEB_ANCHOR_MIRROR;
 
-  void updateCrop(){ crop.x = currentFrame * frameW; crop.y = currentRow * frameH; crop.w = frameW; crop.h = frameH; dst.w = int(frameW*scale); dst.h = int(frameH*scale); }
+  void updateCrop(){ crop.x = sheet.src.x + currentFrame * frameW; crop.y = sheet.src.y + currentRow * frameH; crop.w = frameW; crop.h = frameH; dst.w = int(frameW*scale); dst.h = int(frameH*scale); }
 };
 
-struct Knife { float x{}, y{}, vx{}, vy{}; int w{}, h{}; Uint32 bornMS{}; bool active{true}; double angleDeg{0.0}; double spinDPS{KNIFE_SPIN_DPS}; int dir{+1}; };
-
+// Entity components. Knives and avocados share Position/Velocity/Extent columns; the
+// platforms active this frame are colliders plus a pointer back to the owning Tile.
+struct Position     { float x{}, y{}; };
+struct Velocity     { float vx{}, vy{}; };
+struct Extent       { int w{}, h{}; };
+struct KnifeState   { Uint32 bornMS{}; bool active{true}; double angleDeg{0.0}; double spinDPS{KNIFE_SPIN_DPS}; int dir{+1}; };
+struct AvocadoState { int hp{AVOCADO_HP}; bool split{false}; Uint32 splitUntilMS{0}; Uint32 lastTouchDmgMS{0}; bool counted{false}; bool grounded{false}; Uint8 lod{0}; int supportX0{0}, supportX1{0}; };
+
+// Avocado simulation tiers, picked each tick from the distance to the nearest player.
+enum class SimLod : Uint8 { Full, Reduced, Sleep };
+struct PlatformRef  { Tile* tile{}; };
+
+using KnifeTable    = Archetype<Position, Velocity, Extent, KnifeState>;
+using AvocadoTable  = Archetype<Position, Velocity, Extent, AvocadoState>;
+// Platforms are a per-frame view of the active chunks' tiles, rebuilt by gatherTiles(); rows
+// and handles are only meaningful within the frame. Anything longer-lived holds world coordinates.
+using PlatformTable = Archetype<SDL_Rect, PlatformRef>;
+using Entities      = EntityStore<KnifeTable, AvocadoTable, PlatformTable>;
+
+// Flat avocado value for chunk parking and world files.
 struct Avocado { float x{}, y{}, vx{}, vy{}; int w{}, h{}; int hp{AVOCADO_HP}; bool split{false}; Uint32 splitUntilMS{0}; Uint32 lastTouchDmgMS{0}; bool counted{false}; };
 
+static Entity addAvocado(AvocadoTable& t, const Avocado& a) {
+  return t.create({ a.x, a.y }, { a.vx, a.vy }, { a.w, a.h }, { a.hp, a.split, a.splitUntilMS, a.lastTouchDmgMS, a.counted });
+}
+static Avocado avocadoAt(const AvocadoTable& t, size_t i) {
+  const Position& p = t.column<Position>()[i]; const Velocity& v = t.column<Velocity>()[i];
+  const Extent& e = t.column<Extent>()[i]; const AvocadoState& s = t.column<AvocadoState>()[i];
+  return Avocado{ p.x, p.y, v.vx, v.vy, e.w, e.h, s.hp, s.split, s.splitUntilMS, s.lastTouchDmgMS, s.counted };
+}
+
+static worldfile::TileRec toTileRec(const Tile& t) {
+  return { t.rect.x, t.rect.y, t.rect.w, t.rect.h, { t.glowColor.r, t.glowColor.g, t.glowColor.b, t.glowColor.a },
+           t.isDynamic ? worldfile::StylePurple : worldfile::StyleBlue };
+}
+static Tile fromTileRec(const worldfile::TileRec& r, const AtlasRegion& tex) {
+  return Tile{ { r.x, r.y, r.w, r.h }, tex.tex, SDL_Color{ r.glow[0], r.glow[1], r.glow[2], r.glow[3] }, r.style == worldfile::StylePurple, 0, tex.src };
+}
+static worldfile::AvocadoRec toAvocadoRec(const Avocado& a, Uint32 now) {
+  Uint32 flags = (a.split ? worldfile::AvoSplit : 0u) | (a.counted ? worldfile::AvoCounted : 0u);
+  Uint32 splitLeft = (a.split && a.splitUntilMS > now) ? a.splitUntilMS - now : 0;
+  return { a.x, a.y, a.vx, a.vy, a.w, a.h, a.hp, flags, splitLeft, now - a.lastTouchDmgMS };
+}
+static Avocado fromAvocadoRec(const worldfile::AvocadoRec& r, Uint32 now) {
+  Avocado a{};
+  a.x = r.x; a.y = r.y; a.vx = r.vx; a.vy = r.vy; a.w = r.w; a.h = r.h; a.hp = r.hp;
+  a.split = (r.flags & worldfile::AvoSplit) != 0; a.counted = (r.flags & worldfile::AvoCounted) != 0;
+  a.splitUntilMS = now + r.splitLeftMS; a.lastTouchDmgMS = now - r.sinceTouchMS;
+  return a;
+}
+
+// World streaming: built platforms and parked avocados live in CHUNK_SIZE square chunks.
+// Chunks around the view are active (collided, simulated, drawn); chunks beyond
+// CHUNK_EVICT_MARGIN are written to a per-process scratch dir by a worker thread and read back when
+// the camera returns. Level tiles in `tiles` stay global since they span many chunks.
+class ChunkedWorld {
+public:
+  using TexProvider = std::function<AtlasRegion(bool purple, int w, int h)>;
+  struct Stats {
+    int    active{0}, resident{0}, onDisk{0}, loading{0};
+    size_t activeTiles{0}, dormant{0};
+    Uint32 pagedOut{0}, pagedIn{0};
+  };
+
+  ChunkedWorld(const std::string& dir, TexProvider tex) : dir(dir), tex(std::move(tex)) {
+    std::error_code ec; std::filesystem::remove_all(dir, ec); std::filesystem::create_directories(dir, ec);
+    worker = std::thread([this]{ workerMain(); });
+  }
+  ~ChunkedWorld() {
+    { std::lock_guard<std::mutex> lk(mtx); quit = true; }
+    cv.notify_all(); if (worker.joinable()) worker.join();
+    std::error_code ec; std::filesystem::remove_all(dir, ec);
+  }
+
+  void addTile(const Tile& t) { chunkAt(t.rect.x + t.rect.w/2, t.rect.y + t.rect.h/2).tiles.push_back(t); }
+
+  void update(const SDL_Rect& view, AvocadoTable& avocados, Uint32 now, bool parkAvocados=true) {
+    installLoaded(now);
+    Range act = rangeFor(view, CHUNK_ACTIVE_MARGIN), keep = rangeFor(view, CHUNK_EVICT_MARGIN);
+
+    for (int cy = act.y0; cy <= act.y1; ++cy) for (int cx = act.x0; cx <= act.x1; ++cx) {
+      auto it = chunks.find(key(cx, cy));
+      if (it == chunks.end()) continue;
+      Chunk& c = it->second;
+      if (c.state == Chunk::State::OnDisk) { c.state = Chunk::State::Loading; enqueue(Job{ Job::Read, it->first, {}, {} }); }
+      else if (c.state == Chunk::State::Resident && !c.dormant.empty()) {
+        for (auto& a : c.dormant) addAvocado(avocados, a);
+        c.dormant.clear();
+      }
+    }
+
+    if (parkAvocados) {
+      const auto& pos = avocados.column<Position>(); const auto& ext = avocados.column<Extent>(); const auto& st = avocados.column<AvocadoState>();
+      parked.assign(avocados.size(), 0);
+      for (size_t i = 0; i < avocados.size(); ++i) {
+        if (st[i].split || ext[i].w == 0 || ext[i].h == 0) continue;
+        int ax = int(pos[i].x) + ext[i].w/2, ay = int(pos[i].y) + ext[i].h/2;
+        if (act.contains(chunkCoord(ax), chunkCoord(ay))) continue;
+        chunkAt(ax, ay).dormant.push_back(avocadoAt(avocados, i)); parked[i] = 1;
+      }
+      avocados.removeRows([&](size_t i){ return parked[i] != 0; });
+    }
+
+    for (auto it = chunks.begin(); it != chunks.end(); ) {
+      Chunk& c = it->second;
+      if (c.state != Chunk::State::Resident || keep.contains(it->second.cx, it->second.cy)) { ++it; continue; }
+      if (c.tiles.empty() && c.dormant.empty()) { it = chunks.erase(it); continue; }
+      Job j{ Job::Write, it->first, {}, {} };
+      j.tiles.reserve(c.tiles.size()); for (const auto& t : c.tiles) j.tiles.push_back(toTileRec(t));
+      j.avos.reserve(c.dormant.size()); for (const auto& a : c.dormant) j.avos.push_back(toAvocadoRec(a, now));
+      c.tiles.clear(); c.tiles.shrink_to_fit(); c.dormant.clear(); c.dormant.shrink_to_fit();
+      c.state = Chunk::State::OnDisk; stats_.pagedOut++;
+      enqueue(std::move(j)); ++it;
+    }
+
+    activeRange = act;
+    stats_.active = stats_.resident = stats_.onDisk = stats_.loading = 0; stats_.dormant = 0;
+    for (const auto& kv : chunks) {
+      const Chunk& c = kv.second;
+      if (c.state == Chunk::State::Resident) { stats_.resident++; if (act.contains(c.cx, c.cy)) stats_.active++; }
+      else if (c.state == Chunk::State::OnDisk) stats_.onDisk++;
+      else stats_.loading++;
+      stats_.dormant += c.dormant.size();
+    }
+  }
+
+  // Appends active-chunk tiles to the platform table; refs point back for writes such as glow.
+  void gather(PlatformTable& out) {
+    size_t before = out.size();
+    for (int cy = activeRange.y0; cy <= activeRange.y1; ++cy) for (int cx = activeRange.x0; cx <= activeRange.x1; ++cx) {
+      auto it = chunks.find(key(cx, cy));
+      if (it == chunks.end() || it->second.state != Chunk::State::Resident) continue;
+      for (auto& t : it->second.tiles) out.create(t.rect, PlatformRef{ &t });
+    }
+    stats_.activeTiles = out.size() - before;
+  }
+
+  // Every platform and parked avocado, including paged-out chunks; used by world saves.
+  void collect(std::vector<worldfile::TileRec>& tilesOut, std::vector<worldfile::AvocadoRec>& avosOut, Uint32 now) {
+    flush(); installLoaded(now);
+    for (const auto& kv : chunks) {
+      const Chunk& c = kv.second;
+      for (const auto& t : c.tiles) tilesOut.push_back(toTileRec(t));
+      for (const auto& a : c.dormant) avosOut.push_back(toAvocadoRec(a, now));
+      if (c.state != Chunk::State::OnDisk) continue;
+      worldfile::Reader r; size_t n = 0;
+      if (!r.open(pathFor(kv.first))) continue;
+      if (auto* tr = r.records<worldfile::TileRec>(worldfile::SecPlatforms, n)) tilesOut.insert(tilesOut.end(), tr, tr + n);
+      if (auto* ar = r.records<worldfile::AvocadoRec>(worldfile::SecAvocados, n)) avosOut.insert(avosOut.end(), ar, ar + n);
+    }
+  }
+
+  void clear() {
+    flush();
+    { std::lock_guard<std::mutex> lk(mtx); done.clear(); }
+    chunks.clear(); activeRange = Range{};
+    std::error_code ec; std::filesystem::remove_all(dir, ec); std::filesystem::create_directories(dir, ec);
+  }
+
+  const Stats& stats() const { return stats_; }
+
+private:
+  struct Chunk {
+    enum class State { Resident, OnDisk, Loading } state{State::Resident};
+    int cx{0}, cy{0};
+    std::vector<Tile> tiles;
+    std::vector<Avocado> dormant;
+  };
+  struct Job {
+    enum Kind { Write, Read } kind;
+    Uint64 key;
+    std::vector<worldfile::TileRec> tiles;
+    std::vector<worldfile::AvocadoRec> avos;
+  };
+  struct Range {
+    int x0{0}, y0{0}, x1{-1}, y1{-1};
+    bool contains(int cx, int cy) const { return cx >= x0 && cx <= x1 && cy >= y0 && cy <= y1; }
+  };
+
+  std::string dir;
+  TexProvider tex;
+  std::unordered_map<Uint64, Chunk> chunks;
+  std::vector<Uint8> parked;
+  Range activeRange;
+  Stats stats_;
+
+  std::thread worker;
+  std::mutex mtx;
+  std::condition_variable cv, idleCv;
+  std::deque<Job> jobs, done;
+  int pending = 0;
+  bool quit = false;
+
+  static int chunkCoord(int v) { return (v >= 0) ? v / CHUNK_SIZE : -((-v + CHUNK_SIZE - 1) / CHUNK_SIZE); }
+  static Uint64 key(int cx, int cy) { return (Uint64(Uint32(cx)) << 32) | Uint32(cy); }
+  static Range rangeFor(const SDL_Rect& v, int margin) {
+    return { chunkCoord(v.x) - margin, chunkCoord(v.y) - margin, chunkCoord(v.x + v.w) + margin, chunkCoord(v.y + v.h) + margin };
+  }
+  std::string pathFor(Uint64 k) const {
+    return dir + "/" + std::to_string(Sint32(k >> 32)) + "_" + std::to_string(Sint32(k & 0xFFFFFFFFu)) + ".mkc";
+  }
+
+  // New data for a paged-out chunk waits in memory and is merged when its file comes back.
+  Chunk& chunkAt(int wx, int wy) {
+    int cx = chunkCoord(wx), cy = chunkCoord(wy);
+    Chunk& c = chunks[key(cx, cy)]; c.cx = cx; c.cy = cy;
+    return c;
+  }
+
+  void installLoaded(Uint32 now) {
+    std::deque<Job> ready;
+    { std::lock_guard<std::mutex> lk(mtx); ready.swap(done); }
+    for (auto& j : ready) {
+      auto it = chunks.find(j.key);
+      if (it == chunks.end() || it->second.state != Chunk::State::Loading) continue;
+      Chunk& c = it->second;
+      std::vector<Tile> loaded; loaded.reserve(j.tiles.size() + c.tiles.size());
+      for (const auto& r : j.tiles) loaded.push_back(fromTileRec(r, tex(r.style == worldfile::StylePurple, r.w, r.h)));
+      loaded.insert(loaded.end(), c.tiles.begin(), c.tiles.end()); c.tiles.swap(loaded);
+      for (const auto& r : j.avos) c.dormant.push_back(fromAvocadoRec(r, now));
+      c.state = Chunk::State::Resident; stats_.pagedIn++;
+    }
+  }
+
+  void enqueue(Job&& j) {
+    { std::lock_guard<std::mutex> lk(mtx); jobs.push_back(std::move(j)); pending++; }
+    cv.notify_one();
+  }
+  void flush() {
+    std::unique_lock<std::mutex> lk(mtx);
+    idleCv.wait(lk, [&]{ return pending == 0; });
+  }
+
+  void workerMain() {
+    for (;;) {
+      Job j;
+      {
+        std::unique_lock<std::mutex> lk(mtx);
+        cv.wait(lk, [&]{ return quit || !jobs.empty(); });
+        if (jobs.empty()) return;
+        j = std::move(jobs.front()); jobs.pop_front();
+      }
+      std::string path = pathFor(j.key);
+      if (j.kind == Job::Write) {
+        worldfile::Writer w; w.put(worldfile::SecPlatforms, j.tiles); w.put(worldfile::SecAvocados, j.avos);
+        std::string err;
+        if (!w.save(path, &err)) std::cerr << "chunk write failed: " << path << ": " << err << "\n";
+        j.tiles.clear(); j.avos.clear();
+      } else {
+        worldfile::Reader r; size_t n = 0; std::string err;
+        if (r.open(path, &err)) {
+          if (auto* tr = r.records<worldfile::TileRec>(worldfile::SecPlatforms, n)) j.tiles.assign(tr, tr + n);
+          if (auto* ar = r.records<worldfile::AvocadoRec>(worldfile::SecAvocados, n)) j.avos.assign(ar, ar + n);
+        } else std::cerr << "chunk read failed: " << path << ": " << err << "\n";
+      }
+      {
+        std::lock_guard<std::mutex> lk(mtx);
+        if (j.kind == Job::Read) done.push_back(std::move(j));
+        pending--;
+      }
+      idleCv.notify_all();
+    }
+  }
+};
+
 enum class WebState { None, Shooting, Latched };
 struct Web {
   WebState state{WebState::None};
   bool  rmbHeld{false};
-  int   anchorTile{-1};
   Uint32 startedMS{0};
 
   float ax{0.f}, ay{0.f};  
@@ -428,6 +1050,7 @@ struct Web {
   float pumpGain{0.45f};
 
   float lastTension{0.f};
+  float lastLen{-1.f};
   bool  reelIn{false};
   bool  reelOut{false};
   bool  pump{false};
@@ -447,64 +1070,526 @@ static void drawWigglyWeb(SDL_Renderer* ren, int x1, int y1, int x2, int y2, flo
     float wig = std::sin((s*6.28318f*2.0f) + t*7.0f) * amp * (0.3f + 0.7f*(1.0f - std::fabs(0.5f-s)*2.0f));
     int qx = int(x1 + dx*s + nx*wig);
     int qy = int(y1 + dy*s + ny*wig);
-    SDL_RenderDrawLine(ren, px, py, qx, qy);
+    drawCall(SDL_RenderDrawLine, ren, px, py, qx, qy);
     px=qx; py=qy;
   }
 }
 
-int main() {
+// Voice manager: chunks are decoded to the mixer's PCM format once at load, every
+// play goes through per-sound caps, same-frame dedup, priority stealing and distance culling.
+enum class Sfx { Slice, Throw, Web, Death, Count };
+
+struct SfxDesc {
+  Mix_Chunk* chunk{};
+  int   maxVoices{4};
+  int   priority{0};
+  float volume{1.0f};
+  bool  positional{true};
+};
+
+class VoiceManager {
+public:
+  struct Stats {
+    int    voicesInUse{0}, peakVoices{0}, channels{0};
+    Uint32 played{0}, deduped{0}, stolen{0}, culled{0}, dropped{0};
+  };
+
+  void init(int channelCount) {
+    stats_.channels = Mix_AllocateChannels(channelCount);
+    voices.assign(std::max(0, stats_.channels), Voice{});
+  }
+
+  // Packed PCM is played in place when it was converted for the mixer's current output spec.
+  void setPack(const assetpack::Pack* p) { pack = p; }
+
+  bool load(Sfx id, const std::string& path, int maxVoices, int priority, float volume=1.0f, bool positional=true) {
+    SfxDesc& d = sounds[int(id)];
+    if (d.chunk) Mix_FreeChunk(d.chunk);
+    d.chunk = nullptr;
+    if (const assetpack::Entry* e = pack ? pack->find(path, assetpack::KindSound) : nullptr) {
+      int freq = 0, channels = 0; Uint16 format = 0;
+      if (Mix_QuerySpec(&freq, &format, &channels) && e->w == format && int(e->h) == channels && int(e->param) == freq && e->size <= 0xFFFFFFFFu)
+        d.chunk = Mix_QuickLoad_RAW(const_cast<Uint8*>(pack->data(*e)), Uint32(e->size));
+    }
+    if (!d.chunk) d.chunk = Mix_LoadWAV(path.c_str());
+    if (!d.chunk) { std::cerr << "Mix_LoadWAV(" << path << "): " << Mix_GetError() << "\n"; return false; }
+    d.maxVoices = std::max(1, maxVoices); d.priority = priority; d.volume = volume; d.positional = positional;
+    return true;
+  }
+
+  void beginFrame(float lx, float ly) {
+    ++frameNo; listenerX = lx; listenerY = ly;
+    int busy = 0;
+    for (size_t ch = 0; ch < voices.size(); ++ch) {
+      if (voices[ch].sfx >= 0 && !Mix_Playing((int)ch)) voices[ch] = Voice{};
+      if (voices[ch].sfx >= 0) busy++;
+    }
+    stats_.voicesInUse = busy; stats_.peakVoices = std::max(stats_.peakVoices, busy);
+  }
+
+  int play(Sfx id) { return playAt(id, listenerX, listenerY); }
+
+  int playAt(Sfx id, float wx, float wy) {
+    const SfxDesc& d = sounds[int(id)];
+    if (!d.chunk || voices.empty()) return -1;
+    if (lastFrame[int(id)] == frameNo) { stats_.deduped++; return -1; }
+
+    float gain = 1.0f;
+    if (d.positional) {
+      float dx = wx - listenerX, dy = wy - listenerY, dist = std::sqrt(dx*dx + dy*dy);
+      if (dist >= AUDIO_CULL_DIST) { stats_.culled++; return -1; }
+      if (dist > AUDIO_FALLOFF_START) gain = 1.0f - (dist - AUDIO_FALLOFF_START) / (AUDIO_CULL_DIST - AUDIO_FALLOFF_START);
+    }
+
+    int ch = -1, sameCount = 0, oldestSame = -1;
+    for (size_t i = 0; i < voices.size(); ++i) {
+      if (voices[i].sfx != int(id)) continue;
+      sameCount++;
+      if (oldestSame < 0 || voices[i].startFrame < voices[oldestSame].startFrame) oldestSame = (int)i;
+    }
+    if (sameCount >= d.maxVoices) ch = oldestSame;
+    else {
+      for (size_t i = 0; i < voices.size() && ch < 0; ++i) if (voices[i].sfx < 0) ch = (int)i;
+      if (ch < 0) {
+        for (size_t i = 0; i < voices.size(); ++i) {
+          const Voice& v = voices[i];
+          if (v.priority > d.priority) continue;
+          if (ch < 0 || v.priority < voices[ch].priority || (v.priority == voices[ch].priority && v.startFrame < voices[ch].startFrame)) ch = (int)i;
+        }
+      }
+    }
+    if (ch < 0) { stats_.dropped++; return -1; }
+    const bool stealing = voices[ch].sfx >= 0;
+    if (stealing) { Mix_HaltChannel(ch); stats_.stolen++; }
+
+    Mix_Volume(ch, int(MIX_MAX_VOLUME * AUDIO_MASTER_VOLUME * d.volume * clampf(gain, 0.f, 1.f)));
+    if (Mix_PlayChannel(ch, d.chunk, 0) < 0) {
+      voices[ch] = Voice{}; stats_.dropped++;
+      if (stealing) stats_.voicesInUse = std::max(0, stats_.voicesInUse - 1);
+      return -1;
+    }
+    voices[ch] = Voice{ int(id), d.priority, frameNo };
+    lastFrame[int(id)] = frameNo; stats_.played++;
+    if (!stealing) stats_.voicesInUse = std::min<int>(stats_.voicesInUse + 1, (int)voices.size());
+    stats_.peakVoices = std::max(stats_.peakVoices, stats_.voicesInUse);
+    return ch;
+  }
+
+  void stopAll() { Mix_HaltChannel(-1); for (auto& v : voices) v = Voice{}; stats_.voicesInUse = 0; }
+
+  void freeAll() {
+    stopAll();
+    for (auto& d : sounds) { if (d.chunk) Mix_FreeChunk(d.chunk); d.chunk = nullptr; }
+  }
+
+  bool has(Sfx id) const { return sounds[int(id)].chunk != nullptr; }
+  const Stats& stats() const { return stats_; }
+
+private:
+  struct Voice { int sfx{-1}; int priority{0}; Uint32 startFrame{0}; };
+  SfxDesc sounds[int(Sfx::Count)];
+  Uint32 lastFrame[int(Sfx::Count)]{};
+  const assetpack::Pack* pack = nullptr;
+  std::vector<Voice> voices;
+  Uint32 frameNo = 1;
+  float listenerX = 0.f, listenerY = 0.f;
+  Stats stats_;
+};
+
+struct ParticleBurst {
+  int count; float speedMin, speedMax, lifeMin, lifeMax, sizeMin, sizeMax;
+  SDL_Color c0, c1; float dirDeg, spreadDeg;
+};
+static const ParticleBurst kKnifeSparks { 40,  150.f, 520.f, 0.15f, 0.45f, 2.f, 4.f, {255,240,170,255}, {255,150,40,255},   0.f, 360.f };
+static const ParticleBurst kAvocadoSplat{ 320, 80.f,  620.f, 0.40f, 1.20f, 3.f, 7.f, {120,200,60,255},  {70,120,30,255},  -90.f, 240.f };
+static const ParticleBurst kWebSparks   { 60,  60.f,  360.f, 0.20f, 0.60f, 2.f, 3.f, {235,255,255,255}, {120,200,255,255},  0.f, 360.f };
+static const ParticleBurst kStressBurst { 20000, 50.f, 900.f, 1.0f, 3.0f, 2.f, 4.f, {255,120,255,255}, {80,220,255,255}, -90.f, 360.f };
+
+// Fixed-capacity particle pool. Attributes live in separate float arrays so the update
+// is a straight-line loop the compiler can vectorise; dead particles are swapped out in
+// a second pass. Everything visible is drawn with one SDL_RenderGeometry call.
+class ParticlePool {
+public:
+  struct Stats { size_t peak{0}, dropped{0}, drawn{0}; double updateMs{0}, drawMs{0}; };
+
+  void init(size_t capacity) {
+    cap = capacity; n = 0;
+    for (auto* v : { &x, &y, &vx, &vy, &life, &invLife, &extent }) v->assign(cap, 0.f);
+    color.assign(cap, SDL_Color{0,0,0,0});
+    verts.resize(cap * 4);
+    indices.resize(cap * 6);
+    for (size_t i = 0; i < cap; ++i) {
+      int b = int(i * 4); int* q = &indices[i * 6];
+      q[0] = b; q[1] = b + 1; q[2] = b + 2; q[3] = b + 2; q[4] = b + 3; q[5] = b;
+    }
+  }
+
+  void emit(float px, float py, const ParticleBurst& b) {
+    const float d2r = 3.14159265f / 180.0f;
+    for (int k = 0; k < b.count; ++k) {
+      if (n >= cap) { stats_.dropped += size_t(b.count - k); break; }
+      float a = (b.dirDeg + (rnd() - 0.5f) * b.spreadDeg) * d2r, sp = lerp(b.speedMin, b.speedMax, rnd());
+      float l = lerp(b.lifeMin, b.lifeMax, rnd()), t = rnd();
+      x[n] = px; y[n] = py; vx[n] = std::cos(a) * sp; vy[n] = std::sin(a) * sp;
+      life[n] = l; invLife[n] = 1.0f / l; extent[n] = lerp(b.sizeMin, b.sizeMax, rnd());
+      color[n] = SDL_Color{ Uint8(lerp(b.c0.r, b.c1.r, t)), Uint8(lerp(b.c0.g, b.c1.g, t)), Uint8(lerp(b.c0.b, b.c1.b, t)), 255 };
+      ++n;
+    }
+    stats_.peak = std::max(stats_.peak, n);
+  }
+
+  void update(float dt) {
+    Uint64 t0 = SDL_GetPerformanceCounter();
+    const float g = PARTICLE_GRAVITY * dt, damp = std::max(0.0f, 1.0f - PARTICLE_DRAG * dt);
+    float* __restrict px = x.data(); float* __restrict py = y.data();
+    float* __restrict pvx = vx.data(); float* __restrict pvy = vy.data(); float* __restrict pl = life.data();
+    const size_t count = n;
+    for (size_t i = 0; i < count; ++i) {
+      pvx[i] *= damp; pvy[i] = pvy[i] * damp + g;
+      px[i] += pvx[i] * dt; py[i] += pvy[i] * dt; pl[i] -= dt;
+    }
+    for (size_t i = 0; i < n; ) {
+      if (pl[i] > 0.0f) { ++i; continue; }
+      --n;
+      x[i] = x[n]; y[i] = y[n]; vx[i] = vx[n]; vy[i] = vy[n];
+      life[i] = life[n]; invLife[i] = invLife[n]; extent[i] = extent[n]; color[i] = color[n];
+    }
+    stats_.updateMs = (SDL_GetPerformanceCounter() - t0) * 1000.0 / SDL_GetPerformanceFrequency();
+  }
+
+  void draw(SDL_Renderer* r, int camX, int camY, int viewW, int viewH) {
+    Uint64 t0 = SDL_GetPerformanceCounter();
+    size_t q = 0;
+    for (size_t i = 0; i < n; ++i) {
+      float sx = x[i] - camX, sy = y[i] - camY, h = extent[i] * 0.5f;
+      if (sx < -h || sy < -h || sx > viewW + h || sy > viewH + h) continue;
+      SDL_Color c = color[i]; c.a = Uint8(255.0f * std::min(1.0f, life[i] * invLife[i] * 1.5f));
+      SDL_Vertex* v = &verts[q * 4];
+      v[0] = { { sx - h, sy - h }, c, { 0, 0 } }; v[1] = { { sx + h, sy - h }, c, { 0, 0 } };
+      v[2] = { { sx + h, sy + h }, c, { 0, 0 } }; v[3] = { { sx - h, sy + h }, c, { 0, 0 } };
+      ++q;
+    }
+    if (q) {
+      SDL_SetRenderDrawBlendMode(r, SDL_BLENDMODE_BLEND);
+#if SDL_VERSION_ATLEAST(2,0,18)
+      drawCall(SDL_RenderGeometry, r, nullptr, verts.data(), int(q * 4), indices.data(), int(q * 6));
+#else
+      for (size_t i = 0; i < q; ++i) {
+        const SDL_Vertex* v = &verts[i * 4];
+        SDL_SetRenderDrawColor(r, v->color.r, v->color.g, v->color.b, v->color.a);
+        SDL_FRect fr{ v[0].position.x, v[0].position.y, v[2].position.x - v[0].position.x, v[2].position.y - v[0].position.y };
+        drawCall(SDL_RenderFillRectF, r, &fr);
+      }
+#endif
+    }
+    stats_.drawn = q;
+    stats_.drawMs = (SDL_GetPerformanceCounter() - t0) * 1000.0 / SDL_GetPerformanceFrequency();
+  }
+
+  void clear() { n = 0; }
+  size_t size() const { return n; }
+  size_t capacity() const { return cap; }
+  const Stats& stats() const { return stats_; }
+
+private:
+  size_t cap = 0, n = 0;
+  std::vector<float> x, y, vx, vy, life, invLife, extent;
+  std::vector<SDL_Color> color;
+  std::vector<SDL_Vertex> verts;
+  std::vector<int> indices;
+  Uint32 seed = 0x9E3779B9u;
+  Stats stats_;
+
+  float rnd() { seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5; return (seed >> 8) * (1.0f / 16777216.0f); }
+  static float lerp(float a, float b, float t) { return a + (b - a) * t; }
+};
+
+static const char* pacingName(Pacing m) { return m == Pacing::Vsync ? "vsync" : (m == Pacing::Uncapped ? "uncapped" : "limit"); }
+
+// Frame pacing plus input-to-photon bookkeeping. In Limit mode the pacer sleeps off the
+// spare frame time *before* input is polled, so events and keyboard state are sampled
+// as late as possible ahead of simulate+present. Latency is measured from the earliest
+// input event timestamp of a frame to the return of SDL_RenderPresent.
+class FramePacer {
+public:
+  struct Stats { float lastMs{0}, avgMs{0}, p95Ms{0}, maxMs{0}; Uint32 samples{0}; float frameMs{0}; };
+
+  void init(SDL_Renderer* r, Pacing m) { ren = r; mode = m; nextDeadline = 0; }
+
+  void setMode(Pacing m) {
+    mode = m; nextDeadline = 0;
+#if SDL_VERSION_ATLEAST(2,0,18)
+    if (ren) SDL_RenderSetVSync(ren, m == Pacing::Vsync ? 1 : 0);
+#endif
+  }
+  Pacing getMode() const { return mode; }
+  void cycle() { setMode(mode == Pacing::Vsync ? Pacing::Uncapped : (mode == Pacing::Uncapped ? Pacing::Limit : Pacing::Vsync)); }
+
+  // Call at the top of the frame, before polling events.
+  void waitForFrame() {
+    Uint64 now = SDL_GetPerformanceCounter();
+    if (mode == Pacing::Limit && FRAME_LIMIT_HZ > 0) {
+      const Uint64 freq = SDL_GetPerformanceFrequency(), period = freq / Uint64(FRAME_LIMIT_HZ);
+      if (nextDeadline == 0 || now > nextDeadline + period) nextDeadline = now;
+      const Uint64 spin = freq * Uint64(FRAME_LIMIT_SPIN_US) / 1000000;
+      while (now + spin < nextDeadline) {
+        SDL_Delay(Uint32(std::max<Uint64>(1, (nextDeadline - now - spin) * 1000 / freq)));
+        now = SDL_GetPerformanceCounter();
+      }
+      while (now < nextDeadline) now = SDL_GetPerformanceCounter();
+      nextDeadline += period;
+    }
+    if (frameStart) stats_.frameMs = float((now - frameStart) * 1000.0 / SDL_GetPerformanceFrequency());
+    frameStart = now;
+  }
+
+  void noteInput(Uint32 timestampMS) { if (!pendingInput || timestampMS < pendingMS) { pendingMS = timestampMS; pendingInput = true; } }
+
+  // Call right after SDL_RenderPresent. Event timestamps are on the SDL_GetTicks clock,
+  // so samples have whole-millisecond resolution.
+  void presented() {
+    if (!pendingInput) return;
+    pendingInput = false;
+    float ms = float(SDL_GetTicks() - pendingMS);
+    ring[ringPos] = ms; ringPos = (ringPos + 1) % kRing; ringCount = std::min(ringCount + 1, kRing);
+    stats_.samples++; stats_.lastMs = ms; stats_.maxMs = std::max(stats_.maxMs, ms);
+    stats_.avgMs = (stats_.samples == 1) ? ms : stats_.avgMs + (ms - stats_.avgMs) * 0.05f;
+    float sorted[kRing]; std::copy(ring, ring + ringCount, sorted);
+    size_t k = size_t(ringCount * 0.95f); if (k >= ringCount) k = ringCount - 1;
+    std::nth_element(sorted, sorted + k, sorted + ringCount);
+    stats_.p95Ms = sorted[k];
+    totalMs += ms;
+  }
+
+  const Stats& stats() const { return stats_; }
+  double meanMs() const { return stats_.samples ? totalMs / stats_.samples : 0.0; }
+
+private:
+  static constexpr size_t kRing = 256;
+  SDL_Renderer* ren = nullptr;
+  Pacing mode = Pacing::Vsync;
+  Uint64 nextDeadline = 0, frameStart = 0;
+  Uint32 pendingMS = 0;
+  bool pendingInput = false;
+  float ring[kRing]{}; size_t ringPos = 0, ringCount = 0;
+  double totalMs = 0;
+  Stats stats_;
+};
+
+// Renders the world into an offscreen target at a fraction of the window size and
+// upscales it. The target is allocated once per output size; scale changes only move
+// SDL_RenderSetScale and the source rect, so nothing is reallocated while adapting.
+// Over budget (smoothed frame interval) steps down at once; coming back up needs
+// DRS_UP_FRAMES frames whose CPU-side work leaves clear headroom.
+class DynamicResolution {
+public:
+  ~DynamicResolution() { release(); }
+
+  void init(SDL_Renderer* r) {
+    ren = r; supported = SDL_RenderTargetSupported(r) == SDL_TRUE;
+    if (!supported) std::cerr << "DynamicResolution: render targets not supported, rendering at native resolution\n";
+  }
+  void release() { if (target) SDL_DestroyTexture(target); target = nullptr; tw = th = 0; }
+
+  void update(float frameMs, float workMs, float budgetMs) {
+    if (frameMs <= 0.f) return;
+    avgMs = (avgMs <= 0.f) ? frameMs : avgMs + (frameMs - avgMs) * 0.1f;
+    if (!DRS_ENABLED || !supported) { scale_ = 1.0f; return; }
+    if (cooldown > 0) { --cooldown; return; }
+    if (avgMs > budgetMs * 1.08f && scale_ > DRS_MIN_SCALE) {
+      scale_ = std::max(DRS_MIN_SCALE, scale_ - DRS_STEP); cooldown = 10; headroomFrames = 0; avgMs = budgetMs;
+      return;
+    }
+    headroomFrames = (workMs < budgetMs * 0.70f && avgMs <= budgetMs * 1.02f) ? headroomFrames + 1 : 0;
+    if (headroomFrames >= DRS_UP_FRAMES && scale_ < DRS_MAX_SCALE) {
+      scale_ = std::min(DRS_MAX_SCALE, scale_ + DRS_STEP); cooldown = 10; headroomFrames = 0;
+    }
+  }
+
+  // Redirects world drawing (in window coordinates) into the scaled target.
+  void beginWorld(int outW, int outH) {
+    ow = outW; oh = outH; active = false;
+    if (!supported || scale_ >= 0.999f) return;
+    if (!target || tw != outW || th != outH) {
+      release();
+      target = SDL_CreateTexture(ren, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, outW, outH);
+      if (!target) { std::cerr << "DynamicResolution: " << SDL_GetError() << "\n"; supported = false; return; }
+#if SDL_VERSION_ATLEAST(2,0,12)
+      SDL_SetTextureScaleMode(target, SDL_ScaleModeLinear);
+#endif
+      tw = outW; th = outH;
+    }
+    SDL_SetRenderTarget(ren, target);
+    SDL_RenderSetScale(ren, scale_, scale_);
+    active = true;
+  }
+
+  // Back to the window at native scale, upscaling the world underneath the HUD.
+  void endWorld() {
+    if (!active) return;
+    SDL_RenderSetScale(ren, 1.0f, 1.0f);
+    SDL_SetRenderTarget(ren, nullptr);
+    SDL_Rect src{ 0, 0, renderW(), renderH() };
+    drawCall(SDL_RenderCopy, ren, target, &src, nullptr);
+    active = false;
+  }
+
+  float scale() const { return scale_; }
+  float smoothedMs() const { return avgMs; }
+  size_t textureBytes() const { return ::textureBytes(target); }
+  int renderW() const { return std::max(1, int(std::ceil(ow * scale_))); }
+  int renderH() const { return std::max(1, int(std::ceil(oh * scale_))); }
+
+private:
+  SDL_Renderer* ren = nullptr;
+  SDL_Texture* target = nullptr;
+  bool supported = false, active = false;
+  int tw = 0, th = 0, ow = 0, oh = 0;
+  float scale_ = 1.0f, avgMs = 0.f;
+  int cooldown = 0, headroomFrames = 0;
+};
+
+int main(int argc, char* argv[]) {
+  tCountAllocs = true;
   srand((unsigned)time(nullptr));
 
+  std::string worldArg; int netLatency = -1, netJitter = 0; bool usePack = true;
+  for (int i = 1; i < argc; ++i) {
+    std::string a = argv[i];
+    if (a.rfind("--loopback", 0) == 0) { netLatency = 80; netJitter = 20; if (a.size() > 11 && a[10] == '=') std::sscanf(a.c_str() + 11, "%d:%d", &netLatency, &netJitter); }
+    else if (a == "--no-drs") DRS_ENABLED = false;
+    else if (a == "--no-pack") usePack = false;
+    else if (a == "--no-stats") STATS_EXPORT = false;
+    else if (a.rfind("--stats=", 0) == 0) STATS_SHM_NAME = a.substr(8);
+    else if (a.rfind("--pacing=", 0) == 0) {
+      std::string m = a.substr(9);
+      if (m == "vsync") FRAME_PACING = Pacing::Vsync;
+      else if (m == "uncapped") FRAME_PACING = Pacing::Uncapped;
+      else if (m.rfind("limit", 0) == 0) { FRAME_PACING = Pacing::Limit; if (m.size() > 6 && m[5] == ':') FRAME_LIMIT_HZ = std::max(1, std::atoi(m.c_str() + 6)); }
+      else std::cerr << "Unknown pacing mode " << m << " (vsync, uncapped, limit[:HZ])\n";
+    }
+    else worldArg = a;
+  }
+
   if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) != 0) { std::cerr << "SDL_Init: " << SDL_GetError() << "\n"; return 1; }
   int imgFlags = IMG_INIT_PNG | IMG_INIT_JPG | IMG_INIT_TIF | IMG_INIT_WEBP | IMG_INIT_AVIF; IMG_Init(imgFlags);
   if (TTF_Init() != 0) { std::cerr << "TTF_Init: " << TTF_GetError() << "\n"; }
   int mixFlags = MIX_INIT_MP3 | MIX_INIT_OGG; Mix_Init(mixFlags);
   if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) { std::cerr << "Mix_OpenAudio: " << Mix_GetError() << "\n"; }
-  Mix_AllocateChannels(32); Mix_Volume(-1, int(MIX_MAX_VOLUME * 0.90));
-
-  SDL_Window* win = SDL_CreateWindow("Moki vs Avocados — Swing v2", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_RESIZABLE);
-  SDL_Renderer* ren = SDL_CreateRenderer(win, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
 
-  TTF_Font* font = TTF_OpenFont(kFontTTF.c_str(), 17);
-  TTF_Font* fontBig = TTF_OpenFont(kFontTTF.c_str(), 72);
-
-  Mix_Chunk* sliceSnd = Mix_LoadWAV(kSndSlice.c_str());
-  Mix_Chunk* deathSnd = Mix_LoadWAV(kSndDeath.c_str());
-  Mix_Chunk* throwSnd = Mix_LoadWAV(kSndThrow.c_str());
-  Mix_Chunk* webSnd   = Mix_LoadWAV(kSndWeb.c_str());
-
-  AnimatedTiledBG spaceBG; spaceBG.load(ren, kSpaceGIF);
+  // Pre-decoded assets from tools/assetpack.cpp; anything missing from the pack loads from the loose files.
+  assetpack::Pack pack;
+  if (usePack) {
+    std::string why;
+    if (pack.open(kAssetPack, &why))
+      std::cout << "asset pack: " << kAssetPack << ", " << pack.entryCount() << " entries, " << pack.bytes() / 1024 << " KiB"
+                << (pack.isMapped() ? " mapped\n" : " read\n");
+    else if (std::filesystem::exists(kAssetPack)) std::cerr << "asset pack " << kAssetPack << " ignored: " << why << "\n";
+  }
+  Uint32 assetLoadStart = SDL_GetTicks();
+  VoiceManager audio; audio.init(AUDIO_CHANNELS); audio.setPack(&pack);
+  ParticlePool particles; particles.init(size_t(std::max(0, PARTICLE_CAPACITY)));
 
-  auto makeBluePlatformTex = [&](int w, int h)->SDL_Texture*{
-    SDL_Color bg{10, 20, 40, 255}, line{60, 200, 255, 255}, bands{20, 80, 220, 255};
-    return makeNeonTexture(ren, w, h, bg, line, bands);
+  SDL_Window* win = SDL_CreateWindow("Moki vs Avocados — Swing v2", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_RESIZABLE);
+  SDL_Renderer* ren = SDL_CreateRenderer(win, -1, SDL_RENDERER_ACCELERATED | (FRAME_PACING == Pacing::Vsync ? SDL_RENDERER_PRESENTVSYNC : 0));
+  FramePacer pacer; pacer.init(ren, FRAME_PACING);
+  DynamicResolution drs; drs.init(ren);
+  // Under vsync the frame budget is the display's refresh interval; re-read on fullscreen toggles.
+  auto refreshIntervalMS = [&]{ SDL_DisplayMode m{}; return (SDL_GetWindowDisplayMode(win, &m) == 0 && m.refresh_rate > 0) ? 1000.0f / float(m.refresh_rate) : DRS_TARGET_MS; };
+  float vsyncBudgetMS = refreshIntervalMS();
+  float lastWorkMs = 0.f;
+
+  TextFont font, fontBig;
+  font.open(ren, pack, kFontTTF, 17);
+  fontBig.open(ren, pack, kFontTTF, 72);
+
+  audio.load(Sfx::Slice, kSndSlice, 4, 1, 0.85f);
+  audio.load(Sfx::Throw, kSndThrow, 3, 0, 0.80f);
+  audio.load(Sfx::Web,   kSndWeb,   2, 2, 1.00f);
+  audio.load(Sfx::Death, kSndDeath, 1, 3, 1.00f, false);
+
+  AnimatedTiledBG spaceBG; if (!spaceBG.loadPacked(ren, pack, kSpaceGIF)) spaceBG.load(ren, kSpaceGIF);
+
+  // Packed images are wrapped in place (no copy, no decode); the atlas copies them out before the pack goes away.
+  auto loadSurface = [&](const std::string& path)->SDL_Surface*{
+    if (const assetpack::Entry* e = pack.find(path, assetpack::KindImage))
+      if (e->size >= uint64_t(e->w) * e->h * 4)
+        return SDL_CreateRGBSurfaceWithFormatFrom(const_cast<uint8_t*>(pack.data(*e)), int(e->w), int(e->h), 32, int(e->w) * 4, SDL_PIXELFORMAT_RGBA32);
+    return IMG_Load(path.c_str());
   };
-  auto makePurplePlatformTex = [&](int w, int h)->SDL_Texture*{
-    SDL_Color bg{20, 10, 35, 255}, line{200, 100, 255, 255}, bands{120, 30, 200, 255};
-    return makeNeonTexture(ren, w, h, bg, line, bands);
+  TextureAtlas atlas;
+  // A draw scale below 1 is baked in before packing; *drawScale is left as what the draw still has to apply.
+  auto addImage = [&](const std::string& path, float* drawScale=nullptr)->int{
+    SDL_Surface* s = loadSurface(path);
+    if (!s) { std::cerr << "IMG_Load " << path << ": " << IMG_GetError() << "\n"; return -1; }
+    if (drawScale && *drawScale < 1.0f) {
+      if (SDL_Surface* small = scaledSurface(s, *drawScale)) { SDL_FreeSurface(s); s = small; *drawScale = 1.0f; }
+      else std::cerr << "scale " << path << ": " << SDL_GetError() << "\n";
+    }
+    int id = atlas.add(s); SDL_FreeSurface(s); return id;
+  };
+  float avoTexScale = AVOCADO_SCALE, avoSplitTexScale = AVOCADO_SCALE;
+  int idPlayer = addImage(kPlayerPNG), idKnife = addImage(kWeaponPNG);
+  int idAvo = addImage(kAvoPNG, &avoTexScale), idAvoSplit = addImage(kAvoSplitPNG, &avoSplitTexScale);
+  atlas.build(ren);
+  std::cout << "assets loaded in " << SDL_GetTicks() - assetLoadStart << " ms" << (pack.isOpen() ? " (pack)\n" : " (loose files)\n");
+  const AtlasRegion texKnife = atlas.region(idKnife), texAvo = atlas.region(idAvo), texAvoSplit = atlas.region(idAvoSplit);
+
+  auto makePlatformSurface = [&](bool purple, int w, int h)->SDL_Surface*{
+    if (purple) return makeNeonSurface(w, h, SDL_Color{20, 10, 35, 255}, SDL_Color{200, 100, 255, 255}, SDL_Color{120, 30, 200, 255});
+    return makeNeonSurface(w, h, SDL_Color{10, 20, 40, 255}, SDL_Color{60, 200, 255, 255}, SDL_Color{20, 80, 220, 255});
+  };
+
+  // Platform textures go into the atlas; sizes larger than a page (the ground strip) come back as standalone atlas textures.
+  std::map<std::tuple<bool,int,int>, AtlasRegion> platformTexCache;
+  auto platformTex = [&](bool purple, int w, int h)->AtlasRegion{
+    AtlasRegion& t = platformTexCache[{purple, w, h}];
+    if (t.tex) return t;
+    SDL_Surface* s = makePlatformSurface(purple, w, h);
+    if (!s) return t;
+    int id = atlas.insert(ren, s);
+    if (id >= 0) t = atlas.region(id);
+    SDL_FreeSurface(s);
+    return t;
   };
 
   std::vector<Tile> tiles;
+  AtlasRegion groundTex = platformTex(false, 10000, 50);
   tiles.push_back({
     {-5000, WORLD_GROUND_TOP, 10000, 50},
-    makeBluePlatformTex(10000, 50),
-    SDL_Color{60, 200, 255, 255}, false, 0
+    groundTex.tex,
+    SDL_Color{60, 200, 255, 255}, false, 0, groundTex.src
   });
-  std::vector<Tile> dynPlatforms;
+  ChunkedWorld world(chunkDirForProcess(), platformTex);
 
-  Sprite player(ren, kPlayerPNG, 3, 8);
+  const AtlasRegion playerSheet = atlas.region(idPlayer);
+  auto makePlayerSprite = [&]()->Sprite{ return playerSheet.tex ? Sprite(ren, playerSheet, 3, 8) : Sprite(ren, kPlayerPNG, 3, 8); };
+  Sprite player = makePlayerSprite();
   player.placeOnTopOf(WORLD_GROUND_TOP);
   player.setWebAnchorUV(WEB_ANCHOR_U, WEB_ANCHOR_V, WEB_ANCHOR_MIRROR);
 
-  SDL_Texture* texKnife = nullptr; if (SDL_Surface* s = IMG_Load(kWeaponPNG.c_str())) { texKnife = SDL_CreateTextureFromSurface(ren, s); SDL_FreeSurface(s); SDL_SetTextureBlendMode(texKnife, SDL_BLENDMODE_BLEND); }
-  SDL_Texture* texAvo = nullptr, *texAvoSplit = nullptr;
-  if (SDL_Surface* s1 = IMG_Load(kAvoPNG.c_str())) { texAvo = SDL_CreateTextureFromSurface(ren, s1); SDL_FreeSurface(s1); }
-  if (SDL_Surface* s2 = IMG_Load(kAvoSplitPNG.c_str())) { texAvoSplit = SDL_CreateTextureFromSurface(ren, s2); SDL_FreeSurface(s2); }
-
-  std::vector<Knife>   knives;
-  std::vector<Avocado> avocados;
+  Entities entities;
+  KnifeTable&    knives    = entities.table<KnifeTable>();
+  AvocadoTable&  avocados  = entities.table<AvocadoTable>();
+  PlatformTable& platforms = entities.table<PlatformTable>();
   int playerHP = 100, clipKnives = KNIFE_CLIP; Uint32 lastRecharge = SDL_GetTicks();
+  int remoteClip = KNIFE_CLIP; Uint32 remoteRecharge = lastRecharge;
+  bool rmbDown = false;
+
+  LoopbackPeer peer; RollbackSession session(Uint32((ROLLBACK_WINDOW_MS * SIM_TICK_HZ + 999) / 1000));
+  std::unique_ptr<Sprite> player2;
+  if (netLatency >= 0 && peer.start(netLatency, netJitter)) {
+    player2 = std::make_unique<Sprite>(makePlayerSprite());
+    player2->setTint(150, 255, 170);
+    player2->placeOnTopOf(WORLD_GROUND_TOP); player2->addVelocity(player.getX() + 220.0f - player2->getX(), 0.0f);
+    if (netLatency + netJitter >= ROLLBACK_WINDOW_MS)
+      std::cerr << "--loopback " << netLatency << ":" << netJitter << " exceeds the " << ROLLBACK_WINDOW_MS << " ms rollback window; most remote input will arrive too late\n";
+  }
+  const bool netplay = (player2 != nullptr);
   int avocadosCollected = 0;
+  Uint32 simTick = 0;
+  struct LodCounts { int full{0}, reduced{0}, sleep{0}; } lodCounts;
+  struct WebCounts { Uint32 shots{0}, latches{0}, releases{0}; } webCounts;
   bool fullscreen = false, debugBoxes = false, showHUD = true, nHeld = false;
   bool gameOver = false, deathPlayed = false;
 
@@ -512,211 +1597,278 @@ int main() {
 
   Uint32 prevTick = SDL_GetTicks();
   float dt = 1.0f/60.0f;
+  // The sim runs at SIM_TICK_HZ whatever the pacing mode; simClockMS trails the wall clock by
+  // less than one tick. Edge inputs polled between ticks wait in pendingIn for the next one.
+  const double simTickMS = 1000.0 / SIM_TICK_HZ;
+  double simClockMS = prevTick;
+  TickInput pendingIn;
+
+  struct WorldLoad {
+    std::shared_ptr<worldfile::Reader> reader;
+    const worldfile::TileRec* platforms{nullptr};
+    size_t count{0}, next{0};
+  } worldLoad;
+  std::string statusMsg; Uint32 statusUntilMS = 0;
+  auto setStatus = [&](const std::string& msg){ statusMsg = msg; statusUntilMS = SDL_GetTicks() + 2500; std::cout << msg << "\n"; };
 
   auto resetGame = [&](){
-    knives.clear(); avocados.clear();
-    for (auto& t : dynPlatforms) if (t.texture) SDL_DestroyTexture(t.texture);
-    dynPlatforms.clear();
+    knives.clear(); avocados.clear(); particles.clear();
+    world.clear(); worldLoad = WorldLoad{};
     playerHP = 100; clipKnives = KNIFE_CLIP; lastRecharge = SDL_GetTicks();
     MOON_MODE = false; CAM_Y_ANCHOR = 0.68f; CAM_Y_PIXELS = 0;
-    gameOver = false; deathPlayed = false; avocadosCollected = 0; web = Web{};
+    gameOver = false; deathPlayed = false; avocadosCollected = 0; web = Web{}; simTick = 0;
     player.hardResetPosition(WORLD_GROUND_TOP);
+    if (player2) { player2->hardResetPosition(WORLD_GROUND_TOP); player2->addVelocity(player.getX() + 220.0f - player2->getX(), 0.0f); }
+    remoteClip = KNIFE_CLIP; remoteRecharge = lastRecharge; session.invalidate();
   };
 
-  auto spawnKnife = [&](int dir){
-    if (!texKnife || gameOver) return;
-    if (!KNIFE_UNLIMITED && clipKnives <= 0) return;
-    SDL_Rect pRect = player.worldRect();
-    int kw, kh; SDL_QueryTexture(texKnife, nullptr, nullptr, &kw, &kh);
-    float handX = pRect.x + pRect.w * 0.5f + dir * KNIFE_SPAWN_OFF_X;
-    float handY = pRect.y + pRect.h * KNIFE_SPAWN_HAND_FRAC + KNIFE_SPAWN_OFF_Y;
-    Knife k{}; k.w = int(kw * KNIFE_SCALE); k.h = int(kh * KNIFE_SCALE);
-    k.x = handX - k.w * 0.5f; k.y = handY - k.h * 0.5f; k.vx = KNIFE_SPEED * (dir >= 0 ? 1.0f : -1.0f);
-    k.vy = 0.0f; k.bornMS = SDL_GetTicks(); k.active = true; k.dir = (dir >= 0 ? +1 : -1);
-    knives.push_back(k);
-    if (throwSnd) Mix_PlayChannel(-1, throwSnd, 0);
-    player.triggerThrowPose(THROW_POSE_MS);
-    if (!KNIFE_UNLIMITED) clipKnives--;
+  // Flat snapshot of everything simulateTick mutates: a fixed core block followed by the
+  // knife and avocado tables' columns. Buffers are reused per ring slot, so a save is a few memcpys.
+  struct SimCore {
+    Sprite::PhysState p1, p2; Web web;
+    int playerHP, clipKnives, remoteClip, avocadosCollected;
+    Uint32 lastRecharge, remoteRecharge, simTick;
+    bool gameOver, deathPlayed;
   };
-
-  auto spawnAvocado = [&](float fromX, float fromY){
-    if (!texAvo || gameOver) return;
-    int aw, ah; SDL_QueryTexture(texAvo, nullptr, nullptr, &aw, &ah);
-    Avocado a{}; a.w = int(aw * AVOCADO_SCALE); a.h = int(ah * AVOCADO_SCALE);
-    a.x = fromX; a.y = fromY - a.h; avocados.push_back(a);
+  static_assert(std::is_trivially_copyable_v<SimCore>, "snapshot types must be memcpy-able");
+  auto saveSnapshot = [&](std::vector<Uint8>& buf){
+    SimCore c{ player.physState(), player2 ? player2->physState() : Sprite::PhysState{}, web,
+               playerHP, clipKnives, remoteClip, avocadosCollected, lastRecharge, remoteRecharge, simTick, gameOver, deathPlayed };
+    buf.resize(sizeof(c));
+    std::memcpy(buf.data(), &c, sizeof(c));
+    knives.save(buf); avocados.save(buf);
+  };
+  auto loadSnapshot = [&](const std::vector<Uint8>& buf){
+    SimCore c; const Uint8* r = buf.data();
+    std::memcpy(&c, r, sizeof(c)); r += sizeof(c);
+    player.setPhysState(c.p1); if (player2) player2->setPhysState(c.p2);
+    web = c.web; playerHP = c.playerHP; clipKnives = c.clipKnives; remoteClip = c.remoteClip; avocadosCollected = c.avocadosCollected;
+    lastRecharge = c.lastRecharge; remoteRecharge = c.remoteRecharge; simTick = c.simTick; gameOver = c.gameOver; deathPlayed = c.deathPlayed;
+    r = knives.load(r); avocados.load(r);
   };
 
-  auto avocadoAI = [&](Avocado& a, const std::vector<Tile>& allTiles){
-    a.vy += MOON_MODE ? GRAVITY_MOON : GRAVITY_NORMAL;
-    float playerCenterX = player.centerX(); float aCenterX = a.x + a.w*0.5f;
-    float dir = (playerCenterX > aCenterX) ? +1.0f : -1.0f;
-    float targetVX = AVOCADO_WALK_SPEED * dir;
-    float prevY = a.y; a.y += a.vy;
-    SDL_Rect aRect{ int(a.x), int(a.y), a.w, a.h };
-    const float EPS = 0.5f, MAX_STEP = 24.0f; bool grounded = false;
-    for (const auto& t : allTiles) {
-      if (!overlapX(aRect, t.rect)) continue;
-      float prevBottom = prevY + a.h, nowBottom  = a.y  + a.h;
-      if (a.vy >= 0.0f && prevBottom <= t.rect.y + EPS && nowBottom >= t.rect.y - EPS) {
-        if ((nowBottom - prevBottom) <= (MAX_STEP + std::max(0.0f, a.vy))) {
-          a.y = float(t.rect.y - a.h); a.vy = 0.0f; grounded = true; aRect.y = int(a.y);
-        }
-      }
-    }
-    if (grounded && !a.split) a.vx = targetVX; else a.vx *= 0.97f; a.x += a.vx;
+  auto tileFromRec = [&](const worldfile::TileRec& r)->Tile{ return fromTileRec(r, platformTex(r.style == worldfile::StylePurple, r.w, r.h)); };
+
+  auto gatherTiles = [&](){
+    platforms.clear();
+    for (auto& t : tiles) platforms.create(t.rect, PlatformRef{ &t });
+    world.gather(platforms);
   };
 
-  auto renderBG = [&](int camX, int camY){
-    int outW = SCREEN_WIDTH, outH = SCREEN_HEIGHT; SDL_GetRendererOutputSize(ren, &outW, &outH);
-    spaceBG.render(ren, camX, camY, outW, outH);
+  auto saveWorld = [&](const std::string& path)->bool{
+    using namespace worldfile;
+    Uint32 now = SDL_GetTicks();
+    Writer w;
+    std::vector<TileRec> recs; recs.reserve(tiles.size());
+    for (const auto& t : tiles) recs.push_back(toTileRec(t));
+    w.put(SecTiles, recs); recs.clear();
+
+    std::vector<AvocadoRec> avs; avs.reserve(avocados.size());
+    for (size_t i = 0; i < avocados.size(); ++i) { Avocado a = avocadoAt(avocados, i); if (a.w > 0 && a.h > 0) avs.push_back(toAvocadoRec(a, now)); }
+    world.collect(recs, avs, now);
+    for (size_t i = worldLoad.next; i < worldLoad.count; ++i) recs.push_back(worldLoad.platforms[i]);
+    w.put(SecPlatforms, recs);
+    w.put(SecAvocados, avs);
+
+    std::vector<KnifeRec> ks; ks.reserve(knives.size());
+    knives.each<Position, Velocity, Extent, KnifeState>([&](const Position& p, const Velocity& v, const Extent& e, const KnifeState& k){
+      if (k.active) ks.push_back({ p.x, p.y, v.vx, v.vy, e.w, e.h, k.dir, now - k.bornMS, k.spinDPS });
+    });
+    w.put(SecKnives, ks);
+
+    Sprite::PhysState ps = player.physState();
+    Uint32 pflags = (ps.onGround ? PlayerOnGround : 0u) | (ps.facing == SDL_FLIP_HORIZONTAL ? PlayerFacingLeft : 0u)
+                  | (MOON_MODE ? PlayerMoonMode : 0u) | (KNIFE_UNLIMITED ? PlayerKnivesUnlimited : 0u) | (gameOver ? PlayerGameOver : 0u);
+    w.put(SecPlayer, PlayerRec{ ps.x, ps.y, ps.velX, ps.velY, ps.jumpCount, playerHP, clipKnives, avocadosCollected,
+                                pflags, player.getWebU(), player.getWebV(), now - lastRecharge });
+    w.put(SecWeb, WebRec{ Uint32(web.state), -1, web.ax, web.ay, web.targetLen, web.curLen });
+
+    std::error_code ec; std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+    std::string err;
+    if (!w.save(path, &err)) { std::cerr << "saveWorld(" << path << "): " << err << "\n"; return false; }
+    return true;
   };
 
-  bool running = true;
-  while (running) {
-    Uint32 nowTick = SDL_GetTicks();
-    dt = std::max(1.0f/240.0f, std::min(1.0f/30.0f, (nowTick - prevTick) / 1000.0f));
-    prevTick = nowTick;
+  auto loadWorld = [&](const std::string& path)->bool{
+    using namespace worldfile;
+    auto reader = std::make_shared<Reader>(); std::string err;
+    if (!reader->open(path, &err)) { std::cerr << "loadWorld(" << path << "): " << err << "\n"; return false; }
+    Uint32 now = SDL_GetTicks();
+    size_t n = 0;
 
-    SDL_Event e;
-    while (SDL_PollEvent(&e)) {
-      if (e.type == SDL_QUIT) running = false;
+    if (const TileRec* tr = reader->records<TileRec>(SecTiles, n)) {
+      tiles.clear(); tiles.reserve(n);
+      for (size_t i = 0; i < n; ++i) tiles.push_back(tileFromRec(tr[i]));
+    }
 
-      if (e.type == SDL_KEYDOWN) {
-        if (e.key.keysym.sym == SDLK_r) { resetGame(); }
-        if (!gameOver) {
-          if (e.key.keysym.sym == SDLK_SPACE) player.jump(true);
-          if (e.key.keysym.sym == SDLK_b) { if (!player.isOnGround()) player.startFlip(FlipType::Back, true); }
-          if (e.key.keysym.sym == SDLK_v) { if (!player.isOnGround()) player.startFlip(FlipType::Front, true); }
-          if (e.key.keysym.sym == SDLK_m) { MOON_MODE = !MOON_MODE; }
-          if (e.key.keysym.sym == SDLK_f) { fullscreen = !fullscreen; SDL_SetWindowFullscreen(win, fullscreen ? SDL_WINDOW_FULLSCREEN_DESKTOP : 0); }
-          if (e.key.keysym.sym == SDLK_h)  { debugBoxes = !debugBoxes; }
-          if (e.key.keysym.sym == SDLK_F1) { showHUD = !showHUD; }
-          if (e.key.keysym.sym == SDLK_t)  { KNIFE_UNLIMITED = !KNIFE_UNLIMITED; }
-          if (e.key.keysym.sym == SDLK_o) { float far = (rand()%2==0) ? (player.getX() - 1200.0f) : (player.getX() + 1200.0f); spawnAvocado(far, WORLD_GROUND_TOP - 8); }
-          if (e.key.keysym.sym == SDLK_LEFTBRACKET)  CAM_Y_ANCHOR = std::max(CAM_ANCHOR_MIN, CAM_Y_ANCHOR - CAM_ANCHOR_STEP);
-          if (e.key.keysym.sym == SDLK_RIGHTBRACKET) CAM_Y_ANCHOR = std::min(CAM_ANCHOR_MAX, CAM_Y_ANCHOR + CAM_ANCHOR_STEP);
-          if (e.key.keysym.sym == SDLK_SEMICOLON)    CAM_Y_PIXELS -= CAM_PIXEL_STEP;
-          if (e.key.keysym.sym == SDLK_QUOTE)        CAM_Y_PIXELS += CAM_PIXEL_STEP;
-          if (e.key.keysym.sym == SDLK_g) spaceBG.setParallax(!spaceBG.parallax);
-          if (e.key.keysym.sym == SDLK_9) { if (SDL_GetModState() & KMOD_SHIFT) spaceBG.resetScale(); else spaceBG.addScale(-0.05f); }
-          if (e.key.keysym.sym == SDLK_0) { if (SDL_GetModState() & KMOD_SHIFT) spaceBG.resetScale(); else spaceBG.addScale(+0.05f); }
+    knives.clear(); avocados.clear(); world.clear();
+    if (const AvocadoRec* ar = reader->records<AvocadoRec>(SecAvocados, n)) {
+      avocados.reserve(n);
+      for (size_t i = 0; i < n; ++i) addAvocado(avocados, fromAvocadoRec(ar[i], now));
+    }
+    if (const KnifeRec* kr = reader->records<KnifeRec>(SecKnives, n)) {
+      knives.reserve(n);
+      for (size_t i = 0; i < n; ++i) {
+        const KnifeRec& r = kr[i]; KnifeState k{};
+        k.dir = r.dir; k.bornMS = now - r.ageMS; k.spinDPS = r.spinDPS; k.active = true;
+        knives.create({ r.x, r.y }, { r.vx, r.vy }, { r.w, r.h }, k);
+      }
+    }
+    if (const PlayerRec* pr = reader->records<PlayerRec>(SecPlayer, n)) {
+      const PlayerRec& r = pr[0];
+      player.setPhysState({ r.x, r.y, r.velX, r.velY, r.jumpCount, (r.flags & PlayerOnGround) != 0,
+                            (r.flags & PlayerFacingLeft) ? SDL_FLIP_HORIZONTAL : SDL_FLIP_NONE });
+      player.setWebAnchorUV(r.webU, r.webV, WEB_ANCHOR_MIRROR);
+      playerHP = r.hp; clipKnives = r.clipKnives; avocadosCollected = r.avocadosCollected;
+      MOON_MODE = (r.flags & PlayerMoonMode) != 0; KNIFE_UNLIMITED = (r.flags & PlayerKnivesUnlimited) != 0;
+      gameOver = (r.flags & PlayerGameOver) != 0; deathPlayed = gameOver; lastRecharge = now - r.sinceRechargeMS;
+    }
+    web = Web{};
+    if (const WebRec* wr = reader->records<WebRec>(SecWeb, n)) {
+      const WebRec& r = wr[0];
+      web.state = (r.state <= Uint32(WebState::Latched)) ? WebState(r.state) : WebState::None;
+      web.ax = r.ax; web.ay = r.ay; web.targetLen = r.targetLen; web.curLen = r.curLen;
+      web.startedMS = now;
+    }
 
-          if (e.key.keysym.sym == SDLK_e) web.reelIn  = true;
-          if (e.key.keysym.sym == SDLK_q) web.reelOut = true;
-          if (e.key.keysym.sym == SDLK_LSHIFT || e.key.keysym.sym == SDLK_RSHIFT) web.pump = true;
+    session.invalidate();
+    worldLoad = WorldLoad{};
+    worldLoad.platforms = reader->records<TileRec>(SecPlatforms, worldLoad.count);
+    worldLoad.reader = std::move(reader);
+    return true;
+  };
 
-          float step = (SDL_GetModState() & KMOD_SHIFT) ? 0.03f : 0.01f;
-          if (e.key.keysym.sym == SDLK_i) player.nudgeWebUV(0.f, -step);
-          if (e.key.keysym.sym == SDLK_k) player.nudgeWebUV(0.f, +step);
-          if (e.key.keysym.sym == SDLK_j) player.nudgeWebUV(-step, 0.f);
-          if (e.key.keysym.sym == SDLK_l) player.nudgeWebUV(+step, 0.f);
+  auto pumpWorldLoad = [&](){
+    if (!worldLoad.reader) return;
+    size_t end = std::min(worldLoad.count, worldLoad.next + WORLD_LOAD_BATCH);
+    for (; worldLoad.next < end; ++worldLoad.next) world.addTile(tileFromRec(worldLoad.platforms[worldLoad.next]));
+    if (worldLoad.next >= worldLoad.count) worldLoad = WorldLoad{};
+  };
 
-          if (e.key.keysym.sym == SDLK_ESCAPE) running = false; 
-        } else {
-          if (e.key.keysym.sym == SDLK_r) resetGame();
-          if (e.key.keysym.sym == SDLK_ESCAPE) running = false;
-        }
-      }
-      if (e.type == SDL_KEYUP) {
-        if (e.key.keysym.sym == SDLK_e) web.reelIn  = false;
-        if (e.key.keysym.sym == SDLK_q) web.reelOut = false;
-        if (e.key.keysym.sym == SDLK_LSHIFT || e.key.keysym.sym == SDLK_RSHIFT) web.pump = false;
-      }
+  auto spawnKnife = [&](Sprite& who, int& clip, int dir, Uint32 nowMS, bool muted){
+    if (!texKnife.tex || gameOver) return;
+    if (!KNIFE_UNLIMITED && clip <= 0) return;
+    SDL_Rect pRect = who.worldRect();
+    int kw = texKnife.src.w, kh = texKnife.src.h;
+    float handX = pRect.x + pRect.w * 0.5f + dir * KNIFE_SPAWN_OFF_X;
+    float handY = pRect.y + pRect.h * KNIFE_SPAWN_HAND_FRAC + KNIFE_SPAWN_OFF_Y;
+    Extent e{ int(kw * KNIFE_SCALE), int(kh * KNIFE_SCALE) };
+    KnifeState k{}; k.bornMS = nowMS; k.active = true; k.dir = (dir >= 0 ? +1 : -1);
+    knives.create({ handX - e.w * 0.5f, handY - e.h * 0.5f }, { KNIFE_SPEED * (dir >= 0 ? 1.0f : -1.0f), 0.0f }, e, k);
+    if (!muted) audio.playAt(Sfx::Throw, handX, handY);
+    who.triggerThrowPose(nowMS, THROW_POSE_MS);
+    if (!KNIFE_UNLIMITED) clip--;
+  };
 
-      if (e.type == SDL_MOUSEWHEEL) {
-        if (web.state == WebState::Latched) {
-          float delta = (e.wheel.y > 0 ? -1.f : +1.f) * web.reelRate * 0.02f;
-          web.targetLen = clampf(web.targetLen + delta, web.minLen, web.maxLen);
-        }
-      }
+  auto applyActions = [&](Sprite& who, int& clip, const TickInput& in, Uint32 nowMS, bool muted){
+    if (in.has(TickInput::Jump)) who.jump(true);
+    if (in.has(TickInput::FlipBack))  { if (!who.isOnGround()) who.startFlip(FlipType::Back, true, nowMS); }
+    if (in.has(TickInput::FlipFront)) { if (!who.isOnGround()) who.startFlip(FlipType::Front, true, nowMS); }
+    if (in.has(TickInput::Throw)) spawnKnife(who, clip, (who.getFacing() == SDL_FLIP_HORIZONTAL) ? -1 : +1, nowMS, muted);
+  };
 
-      if (e.type == SDL_KEYDOWN || e.type == SDL_KEYUP) if (e.key.keysym.sym == SDLK_n) nHeld = (e.type == SDL_KEYDOWN);
+  auto shootWeb = [&](int worldX, int worldY, Uint32 nowMS, bool muted){
+    int hitIndex = -1; SDL_Point p{worldX, worldY};
+    const auto& colliders = platforms.column<SDL_Rect>();
+    for (size_t i=0;i<colliders.size();++i){ if (SDL_PointInRect(&p, &colliders[i])) { hitIndex = (int)i; break; } }
+    if (hitIndex == -1) return;
+    web.state = WebState::Shooting;
+    if (!muted) webCounts.shots++;
+    web.ax = (float)worldX; web.ay = (float)worldY;
+    SDL_FPoint wa = player.webAnchorWorld();
+    float dx = web.ax - wa.x; float dy = web.ay - wa.y;
+    float d  = std::sqrt(dx*dx + dy*dy);
+    web.targetLen = clampf(d, web.minLen, web.maxLen);
+    web.curLen = 0.0f;
+    web.startedMS = nowMS;
+    web.rmbHeld = true;
+    player.setFrameLock(true, WEB_LOCK_ROW, WEB_LOCK_COL);
+    if (!muted) audio.playAt(Sfx::Web, wa.x, wa.y);
+  };
 
-      if (!gameOver) {
-        if (e.type == SDL_MOUSEBUTTONDOWN) {
-          if (e.button.button == SDL_BUTTON_LEFT) {
-            int dir = (player.getFacing() == SDL_FLIP_HORIZONTAL) ? -1 : +1; spawnKnife(dir);
-          }
-          if (e.button.button == SDL_BUTTON_RIGHT) {
-            int camX = int(std::floor(player.centerX() - SCREEN_WIDTH *0.5f));
-            int camY = int(std::floor(player.centerY() - SCREEN_HEIGHT*CAM_Y_ANCHOR + CAM_Y_PIXELS));
-            int mx, my; SDL_GetMouseState(&mx, &my);
-            int worldX = mx + camX, worldY = my + camY;
+  auto spawnAvocado = [&](float fromX, float fromY){
+    if (!texAvo.tex || gameOver) return;
+    int aw = texAvo.src.w, ah = texAvo.src.h;
+    Avocado a{}; a.w = int(aw * avoTexScale); a.h = int(ah * avoTexScale);
+    a.x = fromX; a.y = fromY - a.h; addAvocado(avocados, a);
+  };
 
-            if (nHeld) {
-              SDL_Rect r{ worldX - 64, worldY - 12, 128, 24 };
-              Tile t; t.rect = r; t.texture = makePurplePlatformTex(r.w, r.h);
-              t.glowColor = SDL_Color{200, 100, 255, 255}; t.isDynamic = true; dynPlatforms.push_back(t);
-            } else {
-              std::vector<Tile> allTiles = tiles; allTiles.insert(allTiles.end(), dynPlatforms.begin(), dynPlatforms.end());
-              int hitIndex = -1; SDL_Point p{worldX, worldY};
-              for (size_t i=0;i<allTiles.size();++i){ if (SDL_PointInRect(&p, &allTiles[i].rect)) { hitIndex = (int)i; break; } }
-              if (hitIndex != -1) {
-                web.state = WebState::Shooting;
-                web.ax = (float)worldX; web.ay = (float)worldY;
-                SDL_FPoint wa = player.webAnchorWorld();
-                float dx = web.ax - wa.x; float dy = web.ay - wa.y;
-                float d  = std::sqrt(dx*dx + dy*dy);
-                web.targetLen = clampf(d, web.minLen, web.maxLen);
-                web.curLen = 0.0f;
-                web.anchorTile = hitIndex;
-                web.startedMS = SDL_GetTicks();
-                web.rmbHeld = true;
-                player.setFrameLock(true, WEB_LOCK_ROW, WEB_LOCK_COL);
-                if (webSnd) Mix_PlayChannel(-1, webSnd, 0);
-              }
-            }
-          }
-        }
-        if (e.type == SDL_MOUSEBUTTONUP && e.button.button == SDL_BUTTON_RIGHT) {
-          web.rmbHeld = false;
-          player.setFrameLock(false); 
+  auto avocadoAI = [&](Position& a, Velocity& v, const Extent& e, AvocadoState& st, const std::vector<SDL_Rect>& colliders){
+    v.vy += MOON_MODE ? GRAVITY_MOON : GRAVITY_NORMAL;
+    float aCenterX = a.x + e.w*0.5f, playerCenterX = player.centerX();
+    if (player2 && std::fabs(player2->centerX() - aCenterX) < std::fabs(playerCenterX - aCenterX)) playerCenterX = player2->centerX();
+    float dir = (playerCenterX > aCenterX) ? +1.0f : -1.0f;
+    float targetVX = AVOCADO_WALK_SPEED * dir;
+    float prevY = a.y; a.y += v.vy;
+    SDL_Rect aRect{ int(a.x), int(a.y), e.w, e.h };
+    const float EPS = 0.5f, MAX_STEP = 24.0f; bool grounded = false;
+    for (const SDL_Rect& t : colliders) {
+      if (!overlapX(aRect, t)) continue;
+      float prevBottom = prevY + e.h, nowBottom  = a.y  + e.h;
+      if (v.vy >= 0.0f && prevBottom <= t.y + EPS && nowBottom >= t.y - EPS) {
+        if ((nowBottom - prevBottom) <= (MAX_STEP + std::max(0.0f, v.vy))) {
+          if (!grounded) { st.supportX0 = t.x; st.supportX1 = t.x + t.w; }
+          else { st.supportX0 = std::min(st.supportX0, t.x); st.supportX1 = std::max(st.supportX1, t.x + t.w); }
+          a.y = float(t.y - e.h); v.vy = 0.0f; grounded = true; aRect.y = int(a.y);
         }
       }
     }
+    if (grounded && !st.split) v.vx = targetVX; else v.vx *= 0.97f; a.x += v.vx;
+    st.grounded = grounded;
+  };
 
-    std::vector<Tile> allTiles = tiles; allTiles.insert(allTiles.end(), dynPlatforms.begin(), dynPlatforms.end());
+  // One simulation tick. It reads player intent only from TickInput and time only from
+  // the TickClock (Sprite's flip, throw-pose and animation timers take clk.nowMS too), so
+  // the rollback session can restore a snapshot and replay it; `resim`
+  // mutes sounds during replays. `remote` is the co-op partner's input when netplay is on.
+  auto simulateTick = [&](const TickClock& clk, const TickInput& in, const TickInput* remote, bool resim){
+    const Uint32 nowMS = clk.nowMS; const float dt = clk.dt;
+    if (!gameOver) {
+      applyActions(player, clipKnives, in, nowMS, resim);
+      if (remote) applyActions(*player2, remoteClip, *remote, nowMS, resim);
+      if (in.has(TickInput::SpawnAvo)) spawnAvocado(in.spawnSide < 0 ? player.getX() - 1200.0f : player.getX() + 1200.0f, WORLD_GROUND_TOP - 8);
+      if (in.has(TickInput::WebShoot)) shootWeb(in.aimX, in.aimY, nowMS, resim);
+      if (in.wheel != 0 && web.state == WebState::Latched) {
+        float delta = (in.wheel > 0 ? -1.f : +1.f) * web.reelRate * 0.02f;
+        web.targetLen = clampf(web.targetLen + delta, web.minLen, web.maxLen);
+      }
+      web.reelIn = in.has(TickInput::ReelIn); web.reelOut = in.has(TickInput::ReelOut); web.pump = in.has(TickInput::Pump);
+      if (web.rmbHeld && !in.has(TickInput::WebHold)) { web.rmbHeld = false; player.setFrameLock(false); }
+    }
 
-    const Uint8* keys = SDL_GetKeyboardState(nullptr);
-    int landedIdx = player.handleInput(keys, allTiles, !gameOver);
+    const std::vector<SDL_Rect>& colliders = platforms.column<SDL_Rect>();
+    int landedIdx = player.handleInput(in.moveDir(), colliders, !gameOver, nowMS);
 
     if (landedIdx >= 0) {
-      Uint32 now = SDL_GetTicks();
-      if (landedIdx < (int)tiles.size()) tiles[landedIdx].glowUntilMS = now + 120;
-      else {
-        int d = landedIdx - (int)tiles.size();
-        if (d >= 0 && d < (int)dynPlatforms.size()) dynPlatforms[d].glowUntilMS = now + 120;
-      }
+      if (landedIdx < (int)platforms.size()) platforms.column<PlatformRef>()[landedIdx].tile->glowUntilMS = nowMS + 120;
     }
-
-    int camX = int(std::floor(player.centerX() - SCREEN_WIDTH *0.5f));
-    int camY = int(std::floor(player.centerY() - SCREEN_HEIGHT*CAM_Y_ANCHOR + CAM_Y_PIXELS));
+    if (remote) player2->handleInput(remote->moveDir(), colliders, !gameOver, nowMS);
 
     if (!gameOver && !KNIFE_UNLIMITED) {
-      Uint32 now = SDL_GetTicks();
-      if (clipKnives < KNIFE_CLIP && now - lastRecharge >= KNIFE_RECHARGE_MS) { clipKnives++; lastRecharge = now; }
+      if (clipKnives < KNIFE_CLIP && nowMS - lastRecharge >= KNIFE_RECHARGE_MS) { clipKnives++; lastRecharge = nowMS; }
+      if (remote && remoteClip < KNIFE_CLIP && nowMS - remoteRecharge >= KNIFE_RECHARGE_MS) { remoteClip++; remoteRecharge = nowMS; }
     }
 
-    Uint32 nowMS = SDL_GetTicks();
-    for (auto& k : knives) {
-      if (!k.active) continue;
-      k.x += k.vx; k.y += k.vy;
+    knives.each<Position, Velocity, KnifeState>([&](Position& p, const Velocity& v, KnifeState& k){
+      if (!k.active) return;
+      p.x += v.vx; p.y += v.vy;
       double elapsed = (nowMS - k.bornMS) / 1000.0; k.angleDeg = k.dir * k.spinDPS * elapsed;
       if (nowMS - k.bornMS >= KNIFE_LIFETIME_MS) k.active = false;
-    }
+    });
 
     if (web.state == WebState::Shooting) {
       web.curLen += web.shootSpeed * dt;
       if (web.curLen >= web.targetLen) {
         web.curLen = web.targetLen;
         web.state = WebState::Latched;
+        if (!resim) { particles.emit(web.ax, web.ay, kWebSparks); webCounts.latches++; }
       }
     }
 
     if (web.state == WebState::Latched && web.rmbHeld) {
       SDL_FPoint wa = player.webAnchorWorld();
       float px = wa.x, py = wa.y;
-      
+    
       float vx = player.getVelX();
       float vy = player.getVelY();
 
@@ -752,13 +1904,12 @@ int main() {
         vtan += web.pumpGain * g * dt * (0.5f + 0.5f * bias);
       }
 
-      static float lastL = -1.f;
-      if (lastL < 0.f) lastL = L;
-      if (L < lastL * 0.999f) {
-        float scale = std::max(0.5f, std::min(2.0f, lastL / L));
+      if (web.lastLen < 0.f) web.lastLen = L;
+      if (L < web.lastLen * 0.999f) {
+        float scale = std::max(0.5f, std::min(2.0f, web.lastLen / L));
         vtan *= scale;
       }
-      lastL = L;
+      web.lastLen = L;
 
       vx = txv * vtan;
       vy = tyv * vtan;
@@ -779,74 +1930,312 @@ int main() {
         player.addVel(txv * boost, tyv * boost);
       }
       web.state = WebState::None;
+      if (!resim) webCounts.releases++;
       player.setFrameLock(false); 
     }
 
-    if (!gameOver) for (auto& a : avocados) {
-      if (a.split && SDL_GetTicks() >= a.splitUntilMS) { a.w = a.h = 0; continue; }
-      avocadoAI(a, allTiles);
+    // Airborne and nearby avocados run full AI. Grounded ones past SIM_LOD_FULL_DIST run it
+    // every SIM_LOD_REDUCED_INTERVAL ticks (staggered by row) and coast on their walk speed
+    // in between, but only while the coasted position still overlaps the platform span they
+    // last stood on; stepping past its edge runs the AI at once, so they fall instead of
+    // floating and drop to full tier. Split and grounded ones, and those past the sleep
+    // distance, are not simulated until a player comes back within range. That distance is
+    // CHUNK_SIZE * CHUNK_ACTIVE_MARGIN, which the active chunks always cover, so it is reached
+    // before single-player parking takes over (netplay never parks).
+    auto& aPos = avocados.column<Position>(); auto& aVel = avocados.column<Velocity>();
+    auto& aExt = avocados.column<Extent>(); auto& aSt = avocados.column<AvocadoState>();
+    if (!gameOver) {
+      lodCounts = LodCounts{};
+      const float p1x = player.centerX(), p1y = player.centerY();
+      const float p2x = remote ? player2->centerX() : p1x, p2y = remote ? player2->centerY() : p1y;
+      const float sleepAt = std::max(SIM_LOD_FULL_DIST, float(CHUNK_SIZE * CHUNK_ACTIVE_MARGIN));
+      for (size_t i = 0; i < avocados.size(); ++i) {
+        Position& p = aPos[i]; Velocity& v = aVel[i]; Extent& e = aExt[i]; AvocadoState& st = aSt[i];
+        if (st.split && nowMS >= st.splitUntilMS) { e.w = e.h = 0; continue; }
+        SimLod tier = SimLod::Full;
+        if (st.grounded) {
+          float cx = p.x + e.w*0.5f, cy = p.y + e.h*0.5f;
+          float d2 = std::min((cx-p1x)*(cx-p1x) + (cy-p1y)*(cy-p1y), (cx-p2x)*(cx-p2x) + (cy-p2y)*(cy-p2y));
+          float sleepDist = (st.lod == Uint8(SimLod::Sleep)) ? sleepAt * 0.9f : sleepAt;
+          if (st.split || d2 >= sleepDist * sleepDist) tier = SimLod::Sleep;
+          else if (d2 >= SIM_LOD_FULL_DIST * SIM_LOD_FULL_DIST) tier = SimLod::Reduced;
+        }
+        st.lod = Uint8(tier);
+        if (tier == SimLod::Sleep) { lodCounts.sleep++; continue; }
+        if (tier == SimLod::Reduced) {
+          lodCounts.reduced++;
+          if ((simTick + Uint32(i)) % std::max<Uint32>(1, SIM_LOD_REDUCED_INTERVAL) != 0) {
+            float nx = p.x + v.vx;
+            if (nx + e.w > float(st.supportX0) && nx < float(st.supportX1)) { p.x = nx; continue; }
+          }
+        } else lodCounts.full++;
+        avocadoAI(p, v, e, st, colliders);
+      }
     }
 
-    if (!gameOver) for (auto& k : knives) {
-      if (!k.active) continue;
-      SDL_Rect kr{ int(k.x), int(k.y), k.w, k.h };
-      for (auto& a : avocados) {
-        if (a.w==0 || a.h==0) continue;
-        SDL_Rect ar{ int(a.x), int(a.y), a.w, a.h };
+    if (!gameOver) knives.each<Position, Extent, KnifeState>([&](const Position& kp, const Extent& ke, KnifeState& k){
+      if (!k.active) return;
+      SDL_Rect kr{ int(kp.x), int(kp.y), ke.w, ke.h };
+      for (size_t i = 0; i < avocados.size(); ++i) {
+        const Position& ap = aPos[i]; const Extent& ae = aExt[i]; AvocadoState& a = aSt[i];
+        if (ae.w==0 || ae.h==0) continue;
+        SDL_Rect ar{ int(ap.x), int(ap.y), ae.w, ae.h };
         if (SDL_HasIntersection(&kr, &ar)) {
           k.active = false; if (!a.split) {
-            a.hp -= KNIFE_DMG; if (sliceSnd) Mix_PlayChannel(-1, sliceSnd, 0);
-            if (a.hp <= 0) { a.split = true; a.splitUntilMS = SDL_GetTicks() + AVOCADO_SPLIT_SHOWMS; if (!a.counted) { a.counted = true; avocadosCollected++; } }
+            a.hp -= KNIFE_DMG; if (!resim) { audio.playAt(Sfx::Slice, ap.x + ae.w*0.5f, ap.y + ae.h*0.5f); particles.emit(kp.x + ke.w*0.5f, kp.y + ke.h*0.5f, kKnifeSparks); }
+            if (a.hp <= 0) {
+              a.split = true; a.splitUntilMS = nowMS + AVOCADO_SPLIT_SHOWMS; if (!a.counted) { a.counted = true; avocadosCollected++; }
+              if (!resim) particles.emit(ap.x + ae.w*0.5f, ap.y + ae.h*0.5f, kAvocadoSplat);
+            }
           }
           break;
         }
       }
-    }
+    });
 
     if (!gameOver) {
-      SDL_Rect pRect = player.worldRect();
-      for (auto& a : avocados) {
-        if (a.w==0 || a.h==0 || a.split) continue;
-        SDL_Rect ar{ int(a.x), int(a.y), a.w, a.h };
-        if (SDL_HasIntersection(&pRect, &ar)) {
-          Uint32 now = SDL_GetTicks();
-          if (now - a.lastTouchDmgMS >= AVOCADO_DMG_COOLDOWN) { playerHP = std::max(0, playerHP - AVOCADO_CONTACT_DMG); a.lastTouchDmgMS = now; }
+      SDL_Rect pRects[2] = { player.worldRect(), remote ? player2->worldRect() : SDL_Rect{0,0,0,0} };
+      for (size_t i = 0; i < avocados.size(); ++i) {
+        AvocadoState& a = aSt[i];
+        if (aExt[i].w==0 || aExt[i].h==0 || a.split) continue;
+        SDL_Rect ar{ int(aPos[i].x), int(aPos[i].y), aExt[i].w, aExt[i].h };
+        for (const SDL_Rect& pRect : pRects) {
+          if (pRect.w == 0 || !SDL_HasIntersection(&pRect, &ar)) continue;
+          if (nowMS - a.lastTouchDmgMS >= AVOCADO_DMG_COOLDOWN) { playerHP = std::max(0, playerHP - AVOCADO_CONTACT_DMG); a.lastTouchDmgMS = nowMS; }
+        }
+      }
+    }
+
+    const auto& kSt = knives.column<KnifeState>();
+    knives.removeRows([&](size_t i){ return !kSt[i].active; });
+    avocados.removeRows([&](size_t i){ return aExt[i].w==0 || aExt[i].h==0; });
+
+    if (!gameOver && playerHP <= 0) { gameOver = true; if (!deathPlayed && audio.has(Sfx::Death)) { if (!resim) audio.play(Sfx::Death); deathPlayed = true; } }
+    simTick++;
+  };
+
+  auto renderBG = [&](int camX, int camY, int outW, int outH){
+    spaceBG.render(ren, camX, camY, outW, outH);
+  };
+
+  if (!worldArg.empty() && !loadWorld(worldArg)) std::cerr << "Could not open world " << worldArg << ", starting empty\n";
+
+  // Stats export for tools/statsview.cpp. Counters are sampled at the end of every frame and
+  // published every STATS_PUBLISH_MS; nothing here allocates, so it does not skew the alloc count.
+  statsshm::Writer statsOut;
+  if (STATS_EXPORT) {
+    if (statsOut.open(STATS_SHM_NAME)) std::cout << "stats: publishing to shared memory " << STATS_SHM_NAME << "\n";
+    else std::cerr << "stats: could not open shared memory " << STATS_SHM_NAME << ", export disabled\n";
+  }
+  std::array<float, statsshm::kFrameWindow> frameWindow{}, frameSorted{};
+  size_t frameWindowPos = 0, frameWindowCount = 0;
+  Uint64 statsFrame = 0; Uint32 lastStatsMS = 0, drawCallsMax = 0, allocsFrameMax = 0;
+  uint64_t frameAllocs = 0, frameAllocBytes = 0;
+  auto collectStats = [&](uint64_t allocs, uint64_t allocBytes){
+    statsFrame++;
+    frameAllocs = gAllocCount.load(std::memory_order_relaxed) - allocs;
+    frameAllocBytes = gAllocBytes.load(std::memory_order_relaxed) - allocBytes;
+    drawCallsMax = std::max(drawCallsMax, gDrawCalls); allocsFrameMax = std::max(allocsFrameMax, Uint32(frameAllocs));
+    frameWindow[frameWindowPos] = pacer.stats().frameMs;
+    frameWindowPos = (frameWindowPos + 1) % frameWindow.size(); frameWindowCount = std::min(frameWindowCount + 1, frameWindow.size());
+    Uint32 now = SDL_GetTicks();
+    if (!statsOut.isOpen() || now - lastStatsMS < Uint32(std::max(1, STATS_PUBLISH_MS))) return;
+    lastStatsMS = now;
+
+    statsshm::Sample s{};
+    s.frame = statsFrame; s.uptimeMs = now; s.pid = statsshm::Writer::processId();
+    const ChunkedWorld::Stats& cs = world.stats();
+    s.knives = Uint32(knives.size()); s.avocados = Uint32(avocados.size()); s.parkedAvocados = Uint32(cs.dormant);
+    s.platforms = Uint32(platforms.size()); s.particles = Uint32(particles.size()); s.particleCapacity = Uint32(particles.capacity());
+    s.chunksActive = Uint32(cs.active); s.chunksResident = Uint32(cs.resident);
+    s.drawCalls = gDrawCalls; s.drawCallsMax = drawCallsMax;
+    s.allocsFrame = Uint32(frameAllocs); s.allocsFrameMax = allocsFrameMax;
+    s.allocBytesFrame = frameAllocBytes; s.allocsTotal = gAllocCount.load(std::memory_order_relaxed);
+    s.atlasBytes = atlas.pageBytes(); s.standaloneTexBytes = atlas.standaloneBytes();
+    s.backgroundBytes = spaceBG.textureBytes();
+    s.fontBytes = font.textureBytes() + fontBig.textureBytes();
+    s.targetBytes = drs.textureBytes();
+    s.textureBytes = s.atlasBytes + s.standaloneTexBytes + s.backgroundBytes + s.fontBytes + s.targetBytes;
+    s.webState = Uint32(web.state); s.webShots = webCounts.shots; s.webLatches = webCounts.latches; s.webReleases = webCounts.releases;
+    const VoiceManager::Stats& vs = audio.stats();
+    s.voicesInUse = Uint32(vs.voicesInUse); s.voicesPeak = Uint32(vs.peakVoices); s.mixChannels = Uint32(std::max(0, vs.channels));
+    s.mixPlaying = Uint32(std::max(0, Mix_Playing(-1)));
+    s.soundsPlayed = vs.played; s.soundsStolen = vs.stolen; s.soundsCulled = vs.culled; s.soundsDropped = vs.dropped;
+
+    std::copy(frameWindow.begin(), frameWindow.begin() + frameWindowCount, frameSorted.begin());
+    auto quantile = [&](float q){
+      size_t k = std::min(frameWindowCount - 1, size_t(q * frameWindowCount));
+      std::nth_element(frameSorted.begin(), frameSorted.begin() + k, frameSorted.begin() + frameWindowCount);
+      return frameSorted[k];
+    };
+    s.frameMsLast = pacer.stats().frameMs;
+    s.frameMsP50 = quantile(0.50f); s.frameMsP95 = quantile(0.95f); s.frameMsP99 = quantile(0.99f);
+    s.frameMsMax = *std::max_element(frameSorted.begin(), frameSorted.begin() + frameWindowCount);
+    s.workMs = lastWorkMs; s.renderScale = drs.scale();
+    s.rollbacksPerSec = netplay ? session.stats().rollbacksPerSec : 0.f;
+    statsOut.publish(s);
+    drawCallsMax = 0; allocsFrameMax = 0;
+  };
+
+  bool running = true;
+  while (running) {
+    pacer.waitForFrame();
+    const Uint64 frameWorkStart = SDL_GetPerformanceCounter();
+    const uint64_t frameAllocStart = gAllocCount.load(std::memory_order_relaxed), frameAllocBytesStart = gAllocBytes.load(std::memory_order_relaxed);
+    gDrawCalls = 0;
+    Uint32 nowTick = SDL_GetTicks();
+    dt = std::max(1.0f/240.0f, std::min(1.0f/30.0f, (nowTick - prevTick) / 1000.0f));   // render-side effects only
+    prevTick = nowTick;
+    audio.beginFrame(player.centerX(), player.centerY() - SCREEN_HEIGHT*CAM_Y_ANCHOR + CAM_Y_PIXELS + SCREEN_HEIGHT*0.5f);
+
+    SDL_Event e;
+    while (SDL_PollEvent(&e)) {
+      if (e.type == SDL_QUIT) running = false;
+      if ((e.type == SDL_KEYDOWN && !e.key.repeat) || e.type == SDL_MOUSEBUTTONDOWN || e.type == SDL_MOUSEWHEEL) pacer.noteInput(e.common.timestamp);
+
+      if (e.type == SDL_KEYDOWN) {
+        if (e.key.keysym.sym == SDLK_r) { resetGame(); }
+        if (e.key.keysym.sym == SDLK_F8) { DRS_ENABLED = !DRS_ENABLED; setStatus(std::string("Dynamic resolution ") + (DRS_ENABLED ? "on" : "off")); }
+        if (e.key.keysym.sym == SDLK_F7) { pacer.cycle(); setStatus(std::string("Pacing: ") + pacingName(pacer.getMode())); }
+        if (e.key.keysym.sym == SDLK_F5) { Uint64 t0 = SDL_GetPerformanceCounter(); bool ok = saveWorld(kWorldSave);
+          double ms = (SDL_GetPerformanceCounter() - t0) * 1000.0 / SDL_GetPerformanceFrequency();
+          std::ostringstream m; m << (ok ? "Saved " : "Save failed: ") << kWorldSave << " (" << std::fixed << std::setprecision(2) << ms << " ms)"; setStatus(m.str()); }
+        if (e.key.keysym.sym == SDLK_F9) { Uint64 t0 = SDL_GetPerformanceCounter(); bool ok = loadWorld(kWorldSave);
+          double ms = (SDL_GetPerformanceCounter() - t0) * 1000.0 / SDL_GetPerformanceFrequency();
+          std::ostringstream m; m << (ok ? "Loaded " : "Load failed: ") << kWorldSave << " (" << worldLoad.count << " platforms, "
+                                  << std::fixed << std::setprecision(2) << ms << " ms)"; setStatus(m.str()); }
+        if (!gameOver) {
+          if (e.key.keysym.sym == SDLK_SPACE) pendingIn.buttons |= TickInput::Jump;
+          if (e.key.keysym.sym == SDLK_b) pendingIn.buttons |= TickInput::FlipBack;
+          if (e.key.keysym.sym == SDLK_v) pendingIn.buttons |= TickInput::FlipFront;
+          if (e.key.keysym.sym == SDLK_m) { MOON_MODE = !MOON_MODE; }
+          if (e.key.keysym.sym == SDLK_f) { fullscreen = !fullscreen; SDL_SetWindowFullscreen(win, fullscreen ? SDL_WINDOW_FULLSCREEN_DESKTOP : 0); vsyncBudgetMS = refreshIntervalMS(); }
+          if (e.key.keysym.sym == SDLK_h)  { debugBoxes = !debugBoxes; }
+          if (e.key.keysym.sym == SDLK_F1) { showHUD = !showHUD; }
+          if (e.key.keysym.sym == SDLK_t)  { KNIFE_UNLIMITED = !KNIFE_UNLIMITED; }
+          if (e.key.keysym.sym == SDLK_o) { pendingIn.buttons |= TickInput::SpawnAvo; pendingIn.spawnSide = (rand()%2==0) ? -1 : +1; }
+          if (e.key.keysym.sym == SDLK_p) particles.emit(player.centerX(), player.centerY(), kStressBurst);
+          if (e.key.keysym.sym == SDLK_LEFTBRACKET)  CAM_Y_ANCHOR = std::max(CAM_ANCHOR_MIN, CAM_Y_ANCHOR - CAM_ANCHOR_STEP);
+          if (e.key.keysym.sym == SDLK_RIGHTBRACKET) CAM_Y_ANCHOR = std::min(CAM_ANCHOR_MAX, CAM_Y_ANCHOR + CAM_ANCHOR_STEP);
+          if (e.key.keysym.sym == SDLK_SEMICOLON)    CAM_Y_PIXELS -= CAM_PIXEL_STEP;
+          if (e.key.keysym.sym == SDLK_QUOTE)        CAM_Y_PIXELS += CAM_PIXEL_STEP;
+          if (e.key.keysym.sym == SDLK_g) spaceBG.setParallax(!spaceBG.parallax);
+          if (e.key.keysym.sym == SDLK_9) { if (SDL_GetModState() & KMOD_SHIFT) spaceBG.resetScale(); else spaceBG.addScale(-0.05f); }
+          if (e.key.keysym.sym == SDLK_0) { if (SDL_GetModState() & KMOD_SHIFT) spaceBG.resetScale(); else spaceBG.addScale(+0.05f); }
+
+          float step = (SDL_GetModState() & KMOD_SHIFT) ? 0.03f : 0.01f;
+          if (e.key.keysym.sym == SDLK_i) player.nudgeWebUV(0.f, -step);
+          if (e.key.keysym.sym == SDLK_k) player.nudgeWebUV(0.f, +step);
+          if (e.key.keysym.sym == SDLK_j) player.nudgeWebUV(-step, 0.f);
+          if (e.key.keysym.sym == SDLK_l) player.nudgeWebUV(+step, 0.f);
+
+          if (e.key.keysym.sym == SDLK_ESCAPE) running = false; 
+        } else {
+          if (e.key.keysym.sym == SDLK_r) resetGame();
+          if (e.key.keysym.sym == SDLK_ESCAPE) running = false;
+        }
+      }
+      if (e.type == SDL_MOUSEWHEEL && e.wheel.y != 0) pendingIn.wheel = Sint8(e.wheel.y > 0 ? +1 : -1);
+
+      if (e.type == SDL_KEYDOWN || e.type == SDL_KEYUP) if (e.key.keysym.sym == SDLK_n) nHeld = (e.type == SDL_KEYDOWN);
+
+      if (!gameOver) {
+        if (e.type == SDL_MOUSEBUTTONDOWN) {
+          if (e.button.button == SDL_BUTTON_LEFT) pendingIn.buttons |= TickInput::Throw;
+          if (e.button.button == SDL_BUTTON_RIGHT) {
+            int camX = int(std::floor(player.centerX() - SCREEN_WIDTH *0.5f));
+            int camY = int(std::floor(player.centerY() - SCREEN_HEIGHT*CAM_Y_ANCHOR + CAM_Y_PIXELS));
+            int mx, my; SDL_GetMouseState(&mx, &my);
+            int worldX = mx + camX, worldY = my + camY;
+
+            if (nHeld) {
+              SDL_Rect r{ worldX - 64, worldY - 12, 128, 24 };
+              AtlasRegion pt = platformTex(true, r.w, r.h);
+              Tile t; t.rect = r; t.texture = pt.tex; t.src = pt.src;
+              t.glowColor = SDL_Color{200, 100, 255, 255}; t.isDynamic = true; world.addTile(t);
+            } else {
+              pendingIn.buttons |= TickInput::WebShoot; pendingIn.aimX = worldX; pendingIn.aimY = worldY; rmbDown = true;
+            }
+          }
         }
       }
+      if (e.type == SDL_MOUSEBUTTONUP && e.button.button == SDL_BUTTON_RIGHT) rmbDown = false;
     }
 
-    knives.erase(std::remove_if(knives.begin(), knives.end(), [](const Knife& k){ return !k.active; }), knives.end());
-    avocados.erase(std::remove_if(avocados.begin(), avocados.end(), [](const Avocado& a){ return a.w==0 || a.h==0; }), avocados.end());
+    const Uint8* keys = SDL_GetKeyboardState(nullptr);
+    TickInput localIn = pendingIn;
+    if (keys[SDL_SCANCODE_A]) localIn.buttons |= TickInput::Left;
+    if (keys[SDL_SCANCODE_D]) localIn.buttons |= TickInput::Right;
+    if (keys[SDL_SCANCODE_E]) localIn.buttons |= TickInput::ReelIn;
+    if (keys[SDL_SCANCODE_Q]) localIn.buttons |= TickInput::ReelOut;
+    if (keys[SDL_SCANCODE_LSHIFT] || keys[SDL_SCANCODE_RSHIFT]) localIn.buttons |= TickInput::Pump;
+    if (rmbDown) localIn.buttons |= TickInput::WebHold;
+
+    pumpWorldLoad();
+    {
+      int viewX = int(std::floor(player.centerX() - SCREEN_WIDTH *0.5f));
+      int viewY = int(std::floor(player.centerY() - SCREEN_HEIGHT*CAM_Y_ANCHOR + CAM_Y_PIXELS));
+      world.update(SDL_Rect{ viewX, viewY, SCREEN_WIDTH, SCREEN_HEIGHT }, avocados, SDL_GetTicks(), !netplay);
+    }
+    gatherTiles();
+
+    if (netplay) { peer.poll([&](Uint32 tick, const TickInput& in){ session.receiveRemote(tick, in); }); session.beginFrame(); }
+    for (int n = 0; nowTick - simClockMS >= simTickMS; ++n) {
+      if (n == SIM_MAX_CATCHUP) { simClockMS = nowTick - simTickMS * 0.5; break; }   // drop the backlog after a hitch
+      simClockMS += simTickMS;
+      TickClock clk{ Uint32(simClockMS), float(simTickMS / 1000.0) };
+      if (netplay) {
+        peer.send(session.currentTick(), localIn);
+        session.advance(clk, localIn, saveSnapshot, loadSnapshot,
+                        [&](const TickClock& c, const TickInput& l, const TickInput& r, bool resim){ simulateTick(c, l, &r, resim); });
+      } else {
+        simulateTick(clk, localIn, nullptr, false);
+      }
+      localIn = localIn.held(); pendingIn = TickInput{};
+    }
+    particles.update(dt);
 
-    if (!gameOver && playerHP <= 0) { gameOver = true; if (!deathPlayed && deathSnd) { Mix_PlayChannel(-1, deathSnd, 0); deathPlayed = true; } }
+    int camX = int(std::floor(player.centerX() - SCREEN_WIDTH *0.5f));
+    int camY = int(std::floor(player.centerY() - SCREEN_HEIGHT*CAM_Y_ANCHOR + CAM_Y_PIXELS));
 
-    SDL_SetRenderDrawColor(ren, 0,0,0,255); SDL_RenderClear(ren);
-    renderBG(camX, camY);
+    int outW = SCREEN_WIDTH, outH = SCREEN_HEIGHT; SDL_GetRendererOutputSize(ren, &outW, &outH);
+    const Pacing pacing = pacer.getMode();
+    drs.update(pacer.stats().frameMs, lastWorkMs, pacing == Pacing::Limit ? 1000.0f / FRAME_LIMIT_HZ : (pacing == Pacing::Vsync ? vsyncBudgetMS : DRS_TARGET_MS));
+    drs.beginWorld(outW, outH);
+    SDL_SetRenderDrawColor(ren, 0,0,0,255); drawCall(SDL_RenderClear, ren);
+    renderBG(camX, camY, outW, outH);
 
     auto drawPlatform = [&](const Tile& t){
       SDL_Rect r = t.rect; r.x -= camX; r.y -= camY;
-      if (t.texture) SDL_RenderCopy(ren, t.texture, nullptr, &r);
-      else { SDL_SetRenderDrawColor(ren, 80,80,80,255); SDL_RenderFillRect(ren, &r); }
+      if (t.texture) drawCall(SDL_RenderCopy, ren, t.texture, t.src.w ? &t.src : nullptr, &r);
+      else { SDL_SetRenderDrawColor(ren, 80,80,80,255); drawCall(SDL_RenderFillRect, ren, &r); }
       Uint32 now = SDL_GetTicks();
       if (now < t.glowUntilMS) { float pulse = 0.5f + 0.5f*std::sin(now * 0.02f); renderGlowRect(ren, t.rect, camX, camY, t.glowColor, pulse); }
     };
 
-    drawPlatform(tiles[0]);
-    for (size_t i = 1; i < tiles.size(); ++i) drawPlatform(tiles[i]);
-    for (auto& t : dynPlatforms) drawPlatform(t);
-
-    for (auto& a : avocados) {
-      if (a.w==0 || a.h==0) continue;
-      SDL_Rect dst{ int(a.x - camX), int(a.y - camY), a.w, a.h };
-      SDL_Texture* tex = a.split ? texAvoSplit : texAvo;
-      if (tex) SDL_RenderCopy(ren, tex, nullptr, &dst);
+    platforms.each<PlatformRef>([&](const PlatformRef& r){ drawPlatform(*r.tile); });
+
+    avocados.each<Position, Extent, AvocadoState>([&](const Position& p, const Extent& e, const AvocadoState& a){
+      if (e.w==0 || e.h==0) return;
+      SDL_Rect dst{ int(p.x - camX), int(p.y - camY), e.w, e.h };
+      const AtlasRegion& tex = a.split ? texAvoSplit : texAvo;
+      if (tex.tex) drawCall(SDL_RenderCopy, ren, tex.tex, &tex.src, &dst);
+    });
+
+    if (texKnife.tex) knives.each<Position, Extent, KnifeState>([&](const Position& p, const Extent& e, const KnifeState& k){
+      if (!k.active) return;
+      SDL_Rect dst{ int(p.x - camX), int(p.y - camY), e.w, e.h };
+      SDL_Point center{ dst.w/2, dst.h/2 }; drawCall(SDL_RenderCopyEx, ren, texKnife.tex, &texKnife.src, &dst, k.angleDeg, &center, SDL_FLIP_NONE);
+    });
+
+    if (debugBoxes) {
+      SDL_SetRenderDrawColor(ren, 255, 220, 0, 200);
+      entities.each<Position, Extent>([&](const Position& p, const Extent& e){
+        SDL_Rect r{ int(p.x) - camX, int(p.y) - camY, e.w, e.h }; drawCall(SDL_RenderDrawRect, ren, &r);
+      });
     }
 
-    for (auto& k : knives) {
-      if (!k.active) continue;
-      SDL_Rect dst{ int(k.x - camX), int(k.y - camY), k.w, k.h };
-      if (texKnife) { SDL_Point center{ dst.w/2, dst.h/2 }; SDL_RenderCopyEx(ren, texKnife, nullptr, &dst, k.angleDeg, &center, SDL_FLIP_NONE); }
-    }
+    particles.draw(ren, camX, camY, outW, outH);
 
     if (web.state != WebState::None) {
       SDL_FPoint wa = player.webAnchorWorld();
@@ -860,16 +2249,18 @@ int main() {
       drawWigglyWeb(ren, px, py, hx, hy, SDL_GetTicks()/1000.0f);
     }
 
+    if (player2) player2->render(ren, camX, camY, debugBoxes, gameOver);
     player.render(ren, camX, camY, debugBoxes, gameOver);
+    drs.endWorld();
 
     if (showHUD) {
       int barW = 320, barH = 18;
       SDL_Rect hb{ 20, 20, barW, barH };
-      SDL_SetRenderDrawColor(ren, 60,60,60,220); SDL_RenderFillRect(ren, &hb);
+      SDL_SetRenderDrawColor(ren, 60,60,60,220); drawCall(SDL_RenderFillRect, ren, &hb);
       int filled = int(barW * (std::max(0, playerHP) / 100.0f));
       SDL_Rect hf{ 20, 20, std::max(0, filled), barH };
-      SDL_SetRenderDrawColor(ren, 50,230,90,255); SDL_RenderFillRect(ren, &hf);
-      SDL_SetRenderDrawColor(ren, 255,255,255,255); SDL_RenderDrawRect(ren, &hb);
+      SDL_SetRenderDrawColor(ren, 50,230,90,255); drawCall(SDL_RenderFillRect, ren, &hf);
+      SDL_SetRenderDrawColor(ren, 255,255,255,255); drawCall(SDL_RenderDrawRect, ren, &hb);
       if (font) {
         std::stringstream htx; htx << "HP: " << std::max(0, playerHP) << "%"; renderText(ren, font, htx.str(), 24, 42);
         int ax = 20, ay = 70;
@@ -877,9 +2268,9 @@ int main() {
         renderText(ren, font, atx.str(), ax, ay);
         if (!KNIFE_UNLIMITED && clipKnives < KNIFE_CLIP) {
           Uint32 now = SDL_GetTicks(); float p = float(now - lastRecharge) / float(KNIFE_RECHARGE_MS); p = std::max(0.f, std::min(1.f, p));
-          int rw = 180, rh = 10; SDL_Rect rb{ ax, ay+22, rw, rh }; SDL_SetRenderDrawColor(ren, 60,60,60,200); SDL_RenderFillRect(ren, &rb);
-          SDL_Rect rf{ ax, ay+22, int(rw*p), rh }; SDL_SetRenderDrawColor(ren, 255,200,80,255); SDL_RenderFillRect(ren, &rf);
-          SDL_SetRenderDrawColor(ren, 255,255,255,255); SDL_RenderDrawRect(ren, &rb); renderText(ren, font, "recharge", ax+rw+8, ay+16);
+          int rw = 180, rh = 10; SDL_Rect rb{ ax, ay+22, rw, rh }; SDL_SetRenderDrawColor(ren, 60,60,60,200); drawCall(SDL_RenderFillRect, ren, &rb);
+          SDL_Rect rf{ ax, ay+22, int(rw*p), rh }; SDL_SetRenderDrawColor(ren, 255,200,80,255); drawCall(SDL_RenderFillRect, ren, &rf);
+          SDL_SetRenderDrawColor(ren, 255,255,255,255); drawCall(SDL_RenderDrawRect, ren, &rb); renderText(ren, font, "recharge", ax+rw+8, ay+16);
         }
 
         std::string wstate = (web.state==WebState::None ? "None" : (web.state==WebState::Shooting ? "Shooting" : "Latched"));
@@ -896,31 +2287,85 @@ int main() {
                                   << " v=" << std::fixed << std::setprecision(2) << player.getWebV()
                                   << "  (J/L, I/K)";
         renderText(ren, font, uv.str(), 20, ay + 108);
+
+        const VoiceManager::Stats& vs = audio.stats();
+        std::ostringstream vtx; vtx << "Voices " << vs.voicesInUse << "/" << vs.channels << " (peak " << vs.peakVoices << ")"
+                                    << "  played " << vs.played << "  dedup " << vs.deduped << "  stolen " << vs.stolen
+                                    << "  culled " << vs.culled << "  dropped " << vs.dropped;
+        renderText(ren, font, vtx.str(), 20, ay + 132);
+
+        const ChunkedWorld::Stats& cs = world.stats();
+        std::ostringstream ctx; ctx << "Chunks " << cs.active << " active / " << cs.resident << " resident / " << cs.onDisk << " on disk"
+                                    << (cs.loading ? " / " + std::to_string(cs.loading) + " loading" : std::string())
+                                    << "  tiles " << cs.activeTiles << "  dormant " << cs.dormant << "  entities " << entities.size();
+        renderText(ren, font, ctx.str(), 20, ay + 156);
+
+        std::ostringstream atl; atl << "Atlas " << atlas.pageCount() << " page(s)  " << atlas.spriteCount() << " sprites  fill "
+                                    << std::fixed << std::setprecision(0) << atlas.occupancy() * 100.0f << "%  standalone " << atlas.standaloneCount();
+        renderText(ren, font, atl.str(), 20, ay + 180);
+
+        const ParticlePool::Stats& pst = particles.stats();
+        std::ostringstream prt; prt << "Particles " << particles.size() << "/" << particles.capacity() << " (peak " << pst.peak << ", drawn " << pst.drawn
+                                    << ")  update " << std::fixed << std::setprecision(2) << pst.updateMs << " ms  draw " << pst.drawMs << " ms  [P] burst";
+        renderText(ren, font, prt.str(), 20, ay + 204);
+
+        std::ostringstream ltx; ltx << "Sim LOD  full " << lodCounts.full << "  reduced " << lodCounts.reduced << "  sleep " << lodCounts.sleep
+                                    << "  (of " << avocados.size() << " avocados)";
+        renderText(ren, font, ltx.str(), 20, ay + 228);
+
+        const FramePacer::Stats& ps = pacer.stats();
+        std::ostringstream ptx; ptx << "Pacing " << pacingName(pacer.getMode()) << (pacer.getMode() == Pacing::Limit ? ":" + std::to_string(FRAME_LIMIT_HZ) : std::string())
+                                    << "  frame " << std::fixed << std::setprecision(1) << ps.frameMs << " ms  input->present " << ps.lastMs
+                                    << " ms (avg " << ps.avgMs << ", p95 " << ps.p95Ms << ")  [F7]";
+        renderText(ren, font, ptx.str(), 20, ay + 252);
+
+        std::ostringstream rtx; rtx << "Res " << int(drs.scale() * 100.0f + 0.5f) << "% " << drs.renderW() << "x" << drs.renderH()
+                                    << " of " << outW << "x" << outH << "  avg " << std::fixed << std::setprecision(1) << drs.smoothedMs()
+                                    << " ms  work " << lastWorkMs << " ms" << (DRS_ENABLED ? "  [F8]" : "  off [F8]");
+        renderText(ren, font, rtx.str(), 20, ay + 276);
+
+        if (netplay) {
+          const RollbackSession::Stats& ns = session.stats();
+          std::ostringstream ntx; ntx << "Net " << peer.latency() << "+/-" << peer.jitter() << "ms  tick " << ns.tick
+                                      << "  rollbacks " << std::fixed << std::setprecision(1) << ns.rollbacksPerSec << "/s"
+                                      << "  resim " << ns.frameResimTicks << " ticks " << std::setprecision(2) << ns.frameResimMs << " ms (max " << ns.maxResimMs << ")"
+                                      << "  snap " << std::setprecision(1) << ns.snapshotUs << " us  late " << ns.lateInputs;
+          renderText(ren, font, ntx.str(), 20, ay + 300);
+        }
       }
     }
 
+    if (font && SDL_GetTicks() < statusUntilMS) renderText(ren, font, statusMsg, 20, SCREEN_HEIGHT - 40, {255,230,120,255});
+
     if (gameOver) {
       SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_BLEND);
       SDL_SetRenderDrawColor(ren, 0,0,0,160);
-      SDL_Rect full{0,0,SCREEN_WIDTH,SCREEN_HEIGHT}; SDL_RenderFillRect(ren, &full);
+      SDL_Rect full{0,0,SCREEN_WIDTH,SCREEN_HEIGHT}; drawCall(SDL_RenderFillRect, ren, &full);
       if (fontBig) renderText(ren, fontBig, "Knocked DF Out", SCREEN_WIDTH/2 - 120, SCREEN_HEIGHT/2 - 120, {255,80,80,255});
       if (font) renderText(ren, font, "Press [R] to Restart   |   [Esc] to Exit", SCREEN_WIDTH/2 - 220, SCREEN_HEIGHT/2, {255,255,255,255});
     }
 
+    lastWorkMs = float((SDL_GetPerformanceCounter() - frameWorkStart) * 1000.0 / SDL_GetPerformanceFrequency());
     SDL_RenderPresent(ren);
+    pacer.presented();
+    collectStats(frameAllocStart, frameAllocBytesStart);
   }
 
-  for (auto& t : tiles) if (t.texture) SDL_DestroyTexture(t.texture);
-  for (auto& t : dynPlatforms) if (t.texture) SDL_DestroyTexture(t.texture);
-  if (texKnife) SDL_DestroyTexture(texKnife);
-  if (texAvo) SDL_DestroyTexture(texAvo);
-  if (texAvoSplit) SDL_DestroyTexture(texAvoSplit);
-  if (font) TTF_CloseFont(font);
-  if (fontBig) TTF_CloseFont(fontBig);
-  if (sliceSnd) Mix_FreeChunk(sliceSnd);
-  if (deathSnd) Mix_FreeChunk(deathSnd);
-  if (throwSnd) Mix_FreeChunk(throwSnd);
-  if (webSnd) Mix_FreeChunk(webSnd);
+  atlas.destroy();
+  drs.release();
+  font.close(); fontBig.close();
+  {
+    const FramePacer::Stats& ps = pacer.stats();
+    std::cout << "pacing: " << pacingName(pacer.getMode()) << ", input->present " << std::fixed << std::setprecision(2) << pacer.meanMs()
+              << " ms mean, " << ps.p95Ms << " ms p95, " << ps.maxMs << " ms max over " << ps.samples << " inputs\n";
+  }
+  if (netplay) {
+    const RollbackSession::Stats& ns = session.stats();
+    std::cout << "netplay: " << ns.tick << " ticks, " << ns.rollbacks << " rollbacks, " << ns.resimTicks << " resimulated ticks"
+              << " (max depth " << ns.maxDepth << ", max " << ns.maxResimMs << " ms), " << ns.lateInputs << " inputs past the window\n";
+  }
+  peer.stop(); player2.reset();
+  audio.freeAll();
   Mix_CloseAudio(); Mix_Quit();
   SDL_DestroyRenderer(ren); SDL_DestroyWindow(win);
   IMG_Quit(); TTF_Quit(); SDL_Quit();
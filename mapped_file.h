@@ -0,0 +1,74 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Read-only view of a whole file. Uses mmap where available and falls back to a
+// single buffered read, so callers can always treat the contents as one span.
+class MappedFile {
+public:
+  MappedFile() = default;
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  MappedFile(MappedFile&& o) noexcept { *this = std::move(o); }
+  MappedFile& operator=(MappedFile&& o) noexcept {
+    if (this != &o) {
+      close();
+      ptr = o.ptr; len = o.len; mapped = o.mapped; fallback.swap(o.fallback);
+      o.ptr = nullptr; o.len = 0; o.mapped = false;
+    }
+    return *this;
+  }
+  ~MappedFile() { close(); }
+
+  bool open(const std::string& path) {
+    close();
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+      struct stat st{};
+      if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* p = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) { ptr = (const uint8_t*)p; len = size_t(st.st_size); mapped = true; }
+      }
+      ::close(fd);
+      if (mapped) return true;
+    }
+#endif
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) return false;
+    std::streamsize n = in.tellg();
+    if (n <= 0) return false;
+    fallback.resize(size_t(n)); in.seekg(0);
+    if (!in.read((char*)fallback.data(), n)) { fallback.clear(); return false; }
+    ptr = fallback.data(); len = fallback.size();
+    return true;
+  }
+
+  void close() {
+#ifndef _WIN32
+    if (mapped && ptr) munmap((void*)ptr, len);
+#endif
+    ptr = nullptr; len = 0; mapped = false; fallback.clear();
+  }
+
+  const uint8_t* data() const { return ptr; }
+  size_t size() const { return len; }
+  bool isOpen() const { return ptr != nullptr; }
+  bool isMapped() const { return mapped; }
+
+private:
+  const uint8_t* ptr = nullptr;
+  size_t len = 0;
+  bool mapped = false;
+  std::vector<uint8_t> fallback;
+};
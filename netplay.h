@@ -0,0 +1,254 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <thread>
+#include <vector>
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+// One tick of player intent. Everything the simulation reads from a player goes
+// through here, so a tick can be replayed exactly after a rollback.
+struct TickInput {
+  enum : Uint16 {
+    Left = 1, Right = 2, Jump = 4, FlipBack = 8, FlipFront = 16, Throw = 32,
+    WebShoot = 64, WebHold = 128, ReelIn = 256, ReelOut = 512, Pump = 1024, SpawnAvo = 2048
+  };
+  static constexpr Uint16 kEdges = Jump | FlipBack | FlipFront | Throw | WebShoot | SpawnAvo;
+
+  Uint16 buttons{0};
+  Sint8  wheel{0}, spawnSide{0};
+  Sint32 aimX{0}, aimY{0};
+
+  bool has(Uint16 b) const { return (buttons & b) != 0; }
+  int  moveDir() const { return has(Right) ? +1 : (has(Left) ? -1 : 0); }
+  TickInput held() const { TickInput h = *this; h.buttons &= Uint16(~kEdges); h.wheel = 0; h.spawnSide = 0; return h; }
+  bool operator==(const TickInput& o) const {
+    return buttons == o.buttons && wheel == o.wheel && spawnSide == o.spawnSide && aimX == o.aimX && aimY == o.aimY;
+  }
+  bool operator!=(const TickInput& o) const { return !(*this == o); }
+};
+
+// Clock a tick was first simulated with; replays reuse it so timers come out the same.
+struct TickClock { Uint32 nowMS{0}; float dt{1.0f/60.0f}; };
+
+// Keeps a ring of per-tick snapshots and inputs. Remote input is predicted by holding
+// the last confirmed buttons; when a late packet disagrees with the prediction the
+// session restores that tick's snapshot and re-simulates up to the present. Remote input
+// older than the window (in ticks) can no longer be rolled back and counts as late.
+class RollbackSession {
+public:
+  using SaveFn = std::function<void(std::vector<Uint8>&)>;
+  using LoadFn = std::function<void(const std::vector<Uint8>&)>;
+  using StepFn = std::function<void(const TickClock&, const TickInput& local, const TickInput& remote, bool resim)>;
+
+  struct Stats {
+    Uint32 tick{0}, rollbacks{0}, resimTicks{0}, lateInputs{0};
+    int    lastDepth{0}, maxDepth{0}, frameResimTicks{0};
+    double frameResimMs{0}, maxResimMs{0}, snapshotUs{0};
+    float  rollbacksPerSec{0};
+  };
+
+  explicit RollbackSession(Uint32 windowTicks=16) : ring(std::max<Uint32>(2, windowTicks)) {}
+
+  // Drops history after state was changed outside the simulation (reset, world load).
+  void invalidate() {
+    for (auto& s : ring) { s.tick = kNoTick; s.confirmed = false; }
+    early.clear(); rollbackFrom = kNoTick;
+  }
+
+  void receiveRemote(Uint32 tick, const TickInput& in) {
+    if (tick >= lastConfirmedTick || lastConfirmedTick == kNoTick) { lastConfirmedTick = tick; lastConfirmed = in; }
+    if (tick >= next) { early[tick] = in; return; }
+    Slot& s = slot(tick);
+    if (s.tick != tick) { stats_.lateInputs++; return; }
+    if (s.confirmed) return;
+    s.confirmed = true;
+    if (s.remote != in) { s.remote = in; rollbackFrom = std::min(rollbackFrom, tick); }
+  }
+
+  // Resets the per-frame resim counters; advance() may run several fixed ticks in one frame.
+  void beginFrame() { stats_.frameResimTicks = 0; stats_.frameResimMs = 0; }
+
+  void advance(const TickClock& clk, const TickInput& local, const SaveFn& save, const LoadFn& load, const StepFn& step) {
+    if (rollbackFrom != kNoTick) {
+      Uint64 t0 = SDL_GetPerformanceCounter();
+      load(slot(rollbackFrom).snap);
+      TickInput prev = slot(rollbackFrom).remote;
+      for (Uint32 t = rollbackFrom; t < next; ++t) {
+        Slot& s = slot(t);
+        if (t != rollbackFrom) save(s.snap);
+        if (s.confirmed) prev = s.remote; else s.remote = prev.held();
+        step(s.clk, s.local, s.remote, true);
+      }
+      double ms = (SDL_GetPerformanceCounter() - t0) * 1000.0 / SDL_GetPerformanceFrequency();
+      int depth = int(next - rollbackFrom);
+      stats_.rollbacks++; stats_.resimTicks += Uint32(depth);
+      stats_.lastDepth = depth; stats_.maxDepth = std::max(stats_.maxDepth, depth);
+      stats_.frameResimTicks += depth; stats_.frameResimMs += ms; stats_.maxResimMs = std::max(stats_.maxResimMs, ms);
+      windowRollbacks++; rollbackFrom = kNoTick;
+    }
+
+    Slot& s = slot(next);
+    s.tick = next; s.clk = clk; s.local = local;
+    auto it = early.find(next);
+    if (it != early.end()) { s.remote = it->second; s.confirmed = true; early.erase(early.begin(), ++it); }
+    else { s.remote = (lastConfirmedTick == kNoTick) ? TickInput{} : lastConfirmed.held(); s.confirmed = false; }
+
+    Uint64 t0 = SDL_GetPerformanceCounter();
+    save(s.snap);
+    stats_.snapshotUs = (SDL_GetPerformanceCounter() - t0) * 1e6 / SDL_GetPerformanceFrequency();
+    step(clk, local, s.remote, false);
+    stats_.tick = ++next;
+
+    if (clk.nowMS - windowStartMS >= 1000) {
+      stats_.rollbacksPerSec = windowRollbacks * 1000.0f / float(std::max<Uint32>(1, clk.nowMS - windowStartMS));
+      windowRollbacks = 0; windowStartMS = clk.nowMS;
+    }
+  }
+
+  Uint32 currentTick() const { return next; }
+  Uint32 windowTicks() const { return Uint32(ring.size()); }
+  const Stats& stats() const { return stats_; }
+
+private:
+  static constexpr Uint32 kNoTick = 0xFFFFFFFFu;
+  struct Slot {
+    Uint32 tick{kNoTick};
+    TickClock clk;
+    TickInput local, remote;
+    bool confirmed{false};
+    std::vector<Uint8> snap;
+  };
+  Slot& slot(Uint32 tick) { return ring[tick % ring.size()]; }
+  std::vector<Slot> ring;
+  std::map<Uint32, TickInput> early;
+  TickInput lastConfirmed; Uint32 lastConfirmedTick = kNoTick;
+  Uint32 next = 0, rollbackFrom = kNoTick;
+  Uint32 windowStartMS = 0, windowRollbacks = 0;
+  Stats stats_;
+};
+
+// Stand-in remote player: a bot thread behind a UDP loopback socket pair. Every local
+// tick packet is answered with the bot's input for that tick after latency +/- jitter,
+// so packets arrive late and out of order the way a real peer's would.
+class LoopbackPeer {
+public:
+  struct Packet { Uint32 magic; Uint32 tick; TickInput input; };
+  static constexpr Uint32 kMagic = 0x4D4B4E50u;
+
+  ~LoopbackPeer() { stop(); }
+
+  bool start(int latency, int jitter) {
+#ifndef _WIN32
+    latencyMs = std::max(0, latency); jitterMs = std::max(0, jitter);
+    gameSock = openSocket(gameAddr); peerSock = openSocket(peerAddr);
+    if (gameSock < 0 || peerSock < 0) { std::cerr << "LoopbackPeer: could not open UDP sockets\n"; stop(); return false; }
+    fcntl(gameSock, F_SETFL, fcntl(gameSock, F_GETFL, 0) | O_NONBLOCK);
+    running = true;
+    worker = std::thread([this]{ peerMain(); });
+    return true;
+#else
+    (void)latency; (void)jitter;
+    std::cerr << "LoopbackPeer: not supported on this platform\n";
+    return false;
+#endif
+  }
+
+  void stop() {
+    running = false;
+    if (worker.joinable()) worker.join();
+#ifndef _WIN32
+    if (gameSock >= 0) close(gameSock);
+    if (peerSock >= 0) close(peerSock);
+#endif
+    gameSock = peerSock = -1;
+  }
+
+  void send(Uint32 tick, const TickInput& in) {
+#ifndef _WIN32
+    if (gameSock < 0) return;
+    Packet p{ kMagic, tick, in };
+    sendto(gameSock, &p, sizeof(p), 0, (const sockaddr*)&peerAddr, sizeof(peerAddr));
+#else
+    (void)tick; (void)in;
+#endif
+  }
+
+  template <class F> void poll(F onInput) {
+#ifndef _WIN32
+    if (gameSock < 0) return;
+    Packet p;
+    while (recv(gameSock, &p, sizeof(p), 0) == (ssize_t)sizeof(p)) if (p.magic == kMagic) onInput(p.tick, p.input);
+#else
+    (void)onInput;
+#endif
+  }
+
+  bool active() const { return running; }
+  int latency() const { return latencyMs; }
+  int jitter() const { return jitterMs; }
+
+  // Scripted co-op partner: walks back and forth, hops and throws on a fixed rhythm.
+  static TickInput botInput(Uint32 tick) {
+    TickInput in;
+    switch ((tick / 90) % 4) { case 0: in.buttons |= TickInput::Right; break; case 2: in.buttons |= TickInput::Left; break; default: break; }
+    if (tick % 70 == 0) in.buttons |= TickInput::Jump;
+    if (tick % 45 == 0) in.buttons |= TickInput::Throw;
+    return in;
+  }
+
+private:
+  std::thread worker;
+  std::atomic<bool> running{false};
+  int latencyMs = 0, jitterMs = 0;
+  int gameSock = -1, peerSock = -1;
+#ifndef _WIN32
+  sockaddr_in gameAddr{}, peerAddr{};
+
+  static int openSocket(sockaddr_in& addr) {
+    int s = socket(AF_INET, SOCK_DGRAM, 0);
+    if (s < 0) return -1;
+    addr = sockaddr_in{}; addr.sin_family = AF_INET; addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK); addr.sin_port = 0;
+    socklen_t len = sizeof(addr);
+    if (bind(s, (const sockaddr*)&addr, sizeof(addr)) != 0 || getsockname(s, (sockaddr*)&addr, &len) != 0) { close(s); return -1; }
+    return s;
+  }
+
+  void peerMain() {
+    using Clock = std::chrono::steady_clock;
+    struct Due { Clock::time_point at; Packet p; };
+    std::vector<Due> outbox;
+    std::mt19937 rng(0x5eed);
+    std::uniform_int_distribution<int> jit(-jitterMs, jitterMs);
+    while (running) {
+      pollfd pfd{ peerSock, POLLIN, 0 };
+      if (::poll(&pfd, 1, 1) > 0) {
+        Packet p;
+        while (recv(peerSock, &p, sizeof(p), MSG_DONTWAIT) == (ssize_t)sizeof(p)) {
+          if (p.magic != kMagic) continue;
+          int delay = std::max(0, latencyMs + jit(rng));
+          outbox.push_back({ Clock::now() + std::chrono::milliseconds(delay), Packet{ kMagic, p.tick, botInput(p.tick) } });
+        }
+      }
+      Clock::time_point now = Clock::now();
+      for (size_t i = 0; i < outbox.size(); ) {
+        if (outbox[i].at > now) { ++i; continue; }
+        sendto(peerSock, &outbox[i].p, sizeof(Packet), 0, (const sockaddr*)&gameAddr, sizeof(gameAddr));
+        outbox[i] = outbox.back(); outbox.pop_back();
+      }
+    }
+  }
+#endif
+};
@@ -0,0 +1,159 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Live counters the game publishes for outside monitoring (tools/statsview.cpp reads them).
+// One sample sits in a POSIX shared-memory segment behind a sequence counter: the game never
+// blocks or allocates to publish, and a reader that catches a write in progress retries.
+namespace statsshm {
+
+constexpr char     kMagic[8]    = { 'M','O','K','I','S','T','A','T' };
+constexpr uint32_t kVersion     = 2;
+constexpr const char* kDefaultName = "/moki-stats";
+
+enum WebStateId : uint32_t { WebNone, WebShooting, WebLatched };
+
+// Counters are totals since start unless named per frame; frame-time quantiles cover the
+// last kFrameWindow frames before the sample was published.
+struct Sample {
+  uint64_t frame, uptimeMs, pid;
+  uint32_t knives, avocados, parkedAvocados, platforms;
+  uint32_t particles, particleCapacity, chunksActive, chunksResident;
+  uint32_t drawCalls, drawCallsMax;               // render calls in the last frame / max since last sample
+  uint32_t allocsFrame, allocsFrameMax;           // main-thread operator new calls in the last frame / max since last sample
+  uint64_t allocBytesFrame, allocsTotal;
+  uint64_t textureBytes, atlasBytes, standaloneTexBytes, backgroundBytes, fontBytes, targetBytes;
+  uint32_t webState, webShots, webLatches, webReleases;
+  uint32_t voicesInUse, voicesPeak, mixChannels, mixPlaying;
+  uint32_t soundsPlayed, soundsStolen, soundsCulled, soundsDropped;
+  float    frameMsLast, frameMsP50, frameMsP95, frameMsP99, frameMsMax, workMs;
+  float    renderScale, rollbacksPerSec;
+};
+static_assert(sizeof(Sample) % 8 == 0, "sample is copied as 64-bit words");
+constexpr size_t kFrameWindow = 512;
+constexpr size_t kWords = sizeof(Sample) / 8;
+
+struct Segment {
+  char     magic[8];
+  uint32_t version, sampleBytes;
+  std::atomic<uint32_t> seq;   // odd while the writer is mid-update
+  uint32_t pad;
+  std::atomic<uint64_t> words[kWords];
+};
+static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free, "shared counters must be lock-free");
+
+class Writer {
+public:
+  ~Writer() { close(); }
+
+  bool open(const std::string& name=kDefaultName) {
+#ifndef _WIN32
+    close();
+    int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0) return false;
+    bool ok = ftruncate(fd, sizeof(Segment)) == 0;
+    void* p = ok ? mmap(nullptr, sizeof(Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    ::close(fd);
+    if (p == MAP_FAILED) { shm_unlink(name.c_str()); return false; }
+    seg = (Segment*)p; path = name;
+    seg->version = kVersion; seg->sampleBytes = sizeof(Sample);
+    seg->seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(seg->magic, kMagic, sizeof(kMagic));
+    return true;
+#else
+    (void)name; return false;
+#endif
+  }
+
+  void close() {
+#ifndef _WIN32
+    if (!seg) return;
+    munmap(seg, sizeof(Segment)); shm_unlink(path.c_str());
+#endif
+    seg = nullptr;
+  }
+
+  void publish(const Sample& s) {
+    if (!seg) return;
+    uint64_t w[kWords]; std::memcpy(w, &s, sizeof(s));
+    uint32_t q = seg->seq.load(std::memory_order_relaxed);
+    seg->seq.store(q + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < kWords; ++i) seg->words[i].store(w[i], std::memory_order_relaxed);
+    seg->seq.store(q + 2, std::memory_order_release);
+  }
+
+  bool isOpen() const { return seg != nullptr; }
+  const std::string& name() const { return path; }
+#ifndef _WIN32
+  static uint64_t processId() { return uint64_t(getpid()); }
+#else
+  static uint64_t processId() { return 0; }
+#endif
+
+private:
+  Segment* seg = nullptr;
+  std::string path;
+};
+
+class Reader {
+public:
+  ~Reader() { close(); }
+
+  bool open(const std::string& name=kDefaultName) {
+#ifndef _WIN32
+    close();
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) return false;
+    struct stat st{};
+    void* p = (fstat(fd, &st) == 0 && size_t(st.st_size) >= sizeof(Segment)) ? mmap(nullptr, sizeof(Segment), PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+    seg = (const Segment*)p;
+    if (std::memcmp(seg->magic, kMagic, sizeof(kMagic)) != 0 || seg->version != kVersion || seg->sampleBytes != sizeof(Sample)) { close(); return false; }
+    return true;
+#else
+    (void)name; return false;
+#endif
+  }
+
+  void close() {
+#ifndef _WIN32
+    if (seg) munmap((void*)seg, sizeof(Segment));
+#endif
+    seg = nullptr;
+  }
+
+  // False when every attempt overlapped a write; the caller just tries again next poll.
+  bool read(Sample& out, int attempts=64) const {
+    if (!seg) return false;
+    for (int a = 0; a < attempts; ++a) {
+      uint32_t q0 = seg->seq.load(std::memory_order_acquire);
+      if (q0 == 0 || (q0 & 1)) continue;   // nothing published yet, or mid-write
+      uint64_t w[kWords];
+      for (size_t i = 0; i < kWords; ++i) w[i] = seg->words[i].load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (seg->seq.load(std::memory_order_relaxed) != q0) continue;
+      std::memcpy(&out, w, sizeof(out));
+      return true;
+    }
+    return false;
+  }
+
+  bool isOpen() const { return seg != nullptr; }
+
+private:
+  const Segment* seg = nullptr;
+};
+
+}
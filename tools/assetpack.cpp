@@ -0,0 +1,204 @@
+// Offline asset packer: converts game/assets and game/nft into one pre-decoded pack.
+//
+//   g++ -std=c++20 -O2 tools/assetpack.cpp -o assetpack -lSDL2 -lSDL2_image -lSDL2_ttf -lSDL2_mixer
+//   ./assetpack [--font-sizes=17,72] [out.pak] [dir...]     (defaults: game/assets.pak game/assets game/nft)
+//
+// Run it from the repo root: entry names are the paths the game loads (game/assets/...).
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <SDL2/SDL_mixer.h>
+#include <SDL2/SDL_ttf.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../assetpack.h"
+
+using namespace assetpack;
+
+// Must match Mix_OpenAudio in main.cpp; the game checks Mix_QuerySpec and falls back to the MP3s otherwise.
+const int kMixFreq = 44100, kMixChannels = 2;
+
+struct Item { Entry entry; std::vector<uint8_t> bytes; };
+
+static void appendPixels(std::vector<uint8_t>& out, SDL_Surface* src) {
+  SDL_Surface* s = SDL_ConvertSurfaceFormat(src, SDL_PIXELFORMAT_RGBA32, 0);
+  if (!s) return;
+  SDL_LockSurface(s);
+  for (int y = 0; y < s->h; ++y) {
+    const uint8_t* row = (const uint8_t*)s->pixels + size_t(y) * s->pitch;
+    out.insert(out.end(), row, row + size_t(s->w) * 4);
+  }
+  SDL_UnlockSurface(s);
+  SDL_FreeSurface(s);
+}
+static void pad(std::vector<uint8_t>& v) { v.resize(size_t(align(v.size())), 0); }
+
+static Entry makeEntry(const std::string& name, Kind kind) {
+  Entry e{}; std::strncpy(e.name, name.c_str(), sizeof(e.name) - 1); e.kind = kind; return e;
+}
+
+static bool packImage(const std::string& path, std::vector<Item>& out) {
+  SDL_Surface* s = IMG_Load(path.c_str());
+  if (!s) { std::cerr << "  skip " << path << ": " << IMG_GetError() << "\n"; return false; }
+  Item it{ makeEntry(path, KindImage), {} };
+  it.entry.w = uint32_t(s->w); it.entry.h = uint32_t(s->h);
+  appendPixels(it.bytes, s); SDL_FreeSurface(s);
+  out.push_back(std::move(it));
+  return true;
+}
+
+static bool packAnimation(const std::string& path, std::vector<Item>& out) {
+#if SDL_IMAGE_VERSION_ATLEAST(2,6,0)
+  IMG_Animation* a = IMG_LoadAnimation(path.c_str());
+  if (!a || a->count <= 0) { if (a) IMG_FreeAnimation(a); return packImage(path, out); }
+  Item it{ makeEntry(path, KindAnimation), {} };
+  it.entry.w = uint32_t(a->w); it.entry.h = uint32_t(a->h); it.entry.count = uint32_t(a->count);
+  for (int i = 0; i < a->count; ++i) {
+    int32_t d = a->delays ? a->delays[i] : 10;
+    const uint8_t* p = (const uint8_t*)&d; it.bytes.insert(it.bytes.end(), p, p + sizeof(d));
+  }
+  pad(it.bytes);
+  for (int i = 0; i < a->count; ++i) appendPixels(it.bytes, a->frames[i]);
+  IMG_FreeAnimation(a);
+  out.push_back(std::move(it));
+  return true;
+#else
+  return packImage(path, out);
+#endif
+}
+
+static bool packSound(const std::string& path, std::vector<Item>& out) {
+  Mix_Chunk* c = Mix_LoadWAV(path.c_str());
+  if (!c) { std::cerr << "  skip " << path << ": " << Mix_GetError() << "\n"; return false; }
+  int freq = 0, channels = 0; Uint16 format = 0; Mix_QuerySpec(&freq, &format, &channels);
+  Item it{ makeEntry(path, KindSound), std::vector<uint8_t>(c->abuf, c->abuf + c->alen) };
+  it.entry.w = format; it.entry.h = uint32_t(channels); it.entry.param = uint32_t(freq);
+  Mix_FreeChunk(c);
+  out.push_back(std::move(it));
+  return true;
+}
+
+// Shelf-packs Latin-1 glyphs 32..255 into a 1024-wide atlas, matching what TTF_RenderText draws.
+static bool packGlyphs(const std::string& path, int ptsize, std::vector<Item>& out) {
+  TTF_Font* f = TTF_OpenFont(path.c_str(), ptsize);
+  if (!f) { std::cerr << "  skip " << path << "@" << ptsize << ": " << TTF_GetError() << "\n"; return false; }
+  const int atlasW = 1024, lineH = TTF_FontHeight(f);
+  GlyphRec recs[256]{};
+  std::vector<SDL_Surface*> cells(256, nullptr);
+  int penX = 0, penY = 0;
+  for (int c = 32; c < 256; ++c) {
+    if (!TTF_GlyphIsProvided(f, Uint16(c))) continue;
+    int minx, maxx, miny, maxy, adv;
+    if (TTF_GlyphMetrics(f, Uint16(c), &minx, &maxx, &miny, &maxy, &adv) != 0) continue;
+    recs[c].advance = int16_t(adv);
+    SDL_Surface* s = TTF_RenderGlyph_Blended(f, Uint16(c), SDL_Color{255,255,255,255});
+    if (!s) continue;
+    if (penX + s->w > atlasW) { penX = 0; penY += lineH + 1; }
+    recs[c] = GlyphRec{ int16_t(penX), int16_t(penY), int16_t(s->w), int16_t(s->h), int16_t(adv), 0 };
+    cells[c] = s; penX += s->w + 1;
+  }
+  const int atlasH = penY + lineH + 1;
+  SDL_Surface* atlas = SDL_CreateRGBSurfaceWithFormat(0, atlasW, atlasH, 32, SDL_PIXELFORMAT_RGBA32);
+  SDL_FillRect(atlas, nullptr, 0);
+  for (int c = 0; c < 256; ++c) {
+    if (!cells[c]) continue;
+    SDL_SetSurfaceBlendMode(cells[c], SDL_BLENDMODE_NONE);
+    SDL_Rect dst{ recs[c].x, recs[c].y, recs[c].w, recs[c].h };
+    SDL_BlitSurface(cells[c], nullptr, atlas, &dst);
+    SDL_FreeSurface(cells[c]);
+  }
+  Item it{ makeEntry(glyphName(path, ptsize), KindGlyphs), {} };
+  it.entry.w = atlasW; it.entry.h = uint32_t(atlasH); it.entry.count = 256; it.entry.param = uint32_t(lineH);
+  const uint8_t* p = (const uint8_t*)recs; it.bytes.assign(p, p + sizeof(recs));
+  pad(it.bytes);
+  appendPixels(it.bytes, atlas);
+  SDL_FreeSurface(atlas); TTF_CloseFont(f);
+  out.push_back(std::move(it));
+  return true;
+}
+
+static bool writePack(const std::string& path, std::vector<Item>& items) {
+  std::sort(items.begin(), items.end(), [](const Item& a, const Item& b){ return std::strcmp(a.entry.name, b.entry.name) < 0; });
+  Header h{}; std::memcpy(h.magic, kMagic, sizeof(kMagic));
+  h.version = kVersion; h.endianTag = kEndianTag; h.entryCount = uint32_t(items.size());
+  uint64_t off = align(sizeof(Header));
+  for (auto& it : items) { it.entry.offset = off; it.entry.size = it.bytes.size(); off = align(off + it.bytes.size()); }
+  h.indexOffset = off; h.fileSize = off + items.size() * sizeof(Entry);
+  std::string tmp = path + ".tmp";
+  {
+    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+    if (!out) { std::cerr << "cannot create " << tmp << "\n"; return false; }
+    static const char zeros[kAlign] = {};
+    out.write((const char*)&h, sizeof(h));
+    uint64_t at = sizeof(h);
+    for (const auto& it : items) {
+      out.write(zeros, std::streamsize(it.entry.offset - at));
+      out.write((const char*)it.bytes.data(), std::streamsize(it.bytes.size()));
+      at = it.entry.offset + it.bytes.size();
+    }
+    out.write(zeros, std::streamsize(h.indexOffset - at));
+    for (const auto& it : items) out.write((const char*)&it.entry, sizeof(Entry));
+    if (!out) { std::cerr << "write failed: " << tmp << "\n"; return false; }
+  }
+  // std::filesystem::rename replaces an existing pack; std::rename fails on Windows if it exists.
+  std::error_code ec;
+  std::filesystem::rename(tmp, path, ec);
+  if (ec) { std::cerr << "rename " << tmp << " -> " << path << ": " << ec.message() << "\n"; std::filesystem::remove(tmp, ec); return false; }
+  return true;
+}
+
+int main(int argc, char* argv[]) {
+  std::string outPath = "game/assets.pak";
+  std::vector<std::string> dirs;
+  std::vector<int> fontSizes = { 17, 72 };
+  bool outSet = false;
+  for (int i = 1; i < argc; ++i) {
+    std::string a = argv[i];
+    if (a.rfind("--font-sizes=", 0) == 0) {
+      fontSizes.clear(); std::stringstream ss(a.substr(13)); std::string tok;
+      while (std::getline(ss, tok, ',')) if (int v = std::atoi(tok.c_str()); v > 0) fontSizes.push_back(v);
+    }
+    else if (!outSet) { outPath = a; outSet = true; }
+    else dirs.push_back(a);
+  }
+  if (dirs.empty()) dirs = { "game/assets", "game/nft" };
+
+  SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+  if (SDL_Init(SDL_INIT_AUDIO) != 0) { std::cerr << "SDL_Init: " << SDL_GetError() << "\n"; return 1; }
+  IMG_Init(IMG_INIT_PNG | IMG_INIT_JPG | IMG_INIT_TIF | IMG_INIT_WEBP);
+  if (TTF_Init() != 0) { std::cerr << "TTF_Init: " << TTF_GetError() << "\n"; return 1; }
+  Mix_Init(MIX_INIT_MP3 | MIX_INIT_OGG);
+  if (Mix_OpenAudio(kMixFreq, MIX_DEFAULT_FORMAT, kMixChannels, 2048) < 0) { std::cerr << "Mix_OpenAudio: " << Mix_GetError() << "\n"; return 1; }
+
+  std::vector<Item> items;
+  for (const auto& dir : dirs) {
+    std::error_code ec;
+    std::vector<std::filesystem::path> files;
+    for (auto it = std::filesystem::recursive_directory_iterator(dir, ec); !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec))
+      if (it->is_regular_file()) files.push_back(it->path());
+    if (ec) std::cerr << "  " << dir << ": " << ec.message() << "\n";
+    std::sort(files.begin(), files.end());
+    for (const auto& p : files) {
+      std::string ext = p.extension().string(), path = p.generic_string();
+      std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c){ return char(std::tolower(c)); });
+      if (path.size() >= sizeof(Entry::name) - 8) { std::cerr << "  skip " << path << ": name too long\n"; continue; }
+      if (ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".webp" || ext == ".bmp" || ext == ".tif") packImage(path, items);
+      else if (ext == ".gif") packAnimation(path, items);
+      else if (ext == ".mp3" || ext == ".ogg" || ext == ".wav") packSound(path, items);
+      else if (ext == ".ttf" || ext == ".otf") for (int sz : fontSizes) packGlyphs(path, sz, items);
+    }
+  }
+
+  uint64_t payload = 0; for (const auto& it : items) payload += it.bytes.size();
+  bool ok = !items.empty() && writePack(outPath, items);
+  std::cout << (ok ? "wrote " : "failed to write ") << outPath << ": " << items.size() << " entries, " << payload / 1024 << " KiB\n";
+
+  Mix_CloseAudio(); Mix_Quit(); TTF_Quit(); IMG_Quit(); SDL_Quit();
+  return ok ? 0 : 1;
+}
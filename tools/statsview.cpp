@@ -0,0 +1,96 @@
+// Reads the stats the running game publishes to shared memory and logs them at an interval.
+//
+//   g++ -std=c++20 -O2 tools/statsview.cpp -o statsview
+//   ./statsview [--interval=MS] [--csv] [--count=N] [--name=/moki-stats]
+//
+// Waits for the game if it is not running yet and reattaches after it restarts.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "../statsshm.h"
+
+using namespace statsshm;
+
+static const char* webStateName(uint32_t s) { return s == WebShooting ? "shooting" : (s == WebLatched ? "latched" : "none"); }
+static double mib(uint64_t b) { return b / (1024.0 * 1024.0); }
+
+static void printHeader() {
+  std::printf("frame,uptime_ms,knives,avocados,parked,platforms,particles,chunks_active,chunks_resident,"
+              "draw_calls,draw_calls_max,allocs_frame,allocs_frame_max,alloc_bytes_frame,allocs_total,"
+              "tex_bytes,atlas_bytes,standalone_tex_bytes,bg_bytes,font_bytes,target_bytes,"
+              "web_state,web_shots,web_latches,web_releases,voices,voices_peak,mix_channels,mix_playing,"
+              "sounds_played,sounds_stolen,sounds_culled,sounds_dropped,"
+              "frame_ms,p50_ms,p95_ms,p99_ms,max_ms,work_ms,render_scale,rollbacks_per_sec\n");
+}
+
+static void printCsv(const Sample& s) {
+  std::printf("%llu,%llu,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%s,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,"
+              "%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.2f,%.2f\n",
+              (unsigned long long)s.frame, (unsigned long long)s.uptimeMs, s.knives, s.avocados, s.parkedAvocados, s.platforms,
+              s.particles, s.chunksActive, s.chunksResident, s.drawCalls, s.drawCallsMax, s.allocsFrame, s.allocsFrameMax,
+              (unsigned long long)s.allocBytesFrame, (unsigned long long)s.allocsTotal, (unsigned long long)s.textureBytes,
+              (unsigned long long)s.atlasBytes, (unsigned long long)s.standaloneTexBytes, (unsigned long long)s.backgroundBytes,
+              (unsigned long long)s.fontBytes, (unsigned long long)s.targetBytes, webStateName(s.webState), s.webShots, s.webLatches,
+              s.webReleases, s.voicesInUse, s.voicesPeak, s.mixChannels, s.mixPlaying, s.soundsPlayed, s.soundsStolen, s.soundsCulled,
+              s.soundsDropped, s.frameMsLast, s.frameMsP50, s.frameMsP95, s.frameMsP99, s.frameMsMax, s.workMs, s.renderScale, s.rollbacksPerSec);
+}
+
+static void printText(const Sample& s) {
+  std::printf("[%7.1fs] frame %llu | frame ms p50 %.2f p95 %.2f p99 %.2f max %.2f (work %.2f, scale %.2f)\n",
+              s.uptimeMs / 1000.0, (unsigned long long)s.frame, s.frameMsP50, s.frameMsP95, s.frameMsP99, s.frameMsMax, s.workMs, s.renderScale);
+  std::printf("           entities: %u knives, %u avocados (+%u parked), %u platforms, %u/%u particles, chunks %u active / %u resident\n",
+              s.knives, s.avocados, s.parkedAvocados, s.platforms, s.particles, s.particleCapacity, s.chunksActive, s.chunksResident);
+  std::printf("           render: %u calls (max %u), textures %.1f MiB (atlas %.1f, standalone %.1f, bg %.1f, font %.1f, target %.1f)\n",
+              s.drawCalls, s.drawCallsMax, mib(s.textureBytes), mib(s.atlasBytes), mib(s.standaloneTexBytes), mib(s.backgroundBytes),
+              mib(s.fontBytes), mib(s.targetBytes));
+  std::printf("           main-thread allocs: %u/frame (max %u, %llu bytes), %llu total | web %s: %u shots, %u latches, %u releases\n",
+              s.allocsFrame, s.allocsFrameMax, (unsigned long long)s.allocBytesFrame, (unsigned long long)s.allocsTotal,
+              webStateName(s.webState), s.webShots, s.webLatches, s.webReleases);
+  std::printf("           audio: %u/%u voices (peak %u), %u mixer channels playing | played %u stolen %u culled %u dropped %u\n",
+              s.voicesInUse, s.mixChannels, s.voicesPeak, s.mixPlaying, s.soundsPlayed, s.soundsStolen, s.soundsCulled, s.soundsDropped);
+  if (s.rollbacksPerSec > 0) std::printf("           netplay: %.1f rollbacks/s\n", s.rollbacksPerSec);
+}
+
+int main(int argc, char* argv[]) {
+  std::string name = kDefaultName;
+  int intervalMs = 1000; long count = -1; bool csv = false;
+  for (int i = 1; i < argc; ++i) {
+    std::string a = argv[i];
+    if (a.rfind("--interval=", 0) == 0) intervalMs = std::max(10, std::atoi(a.c_str() + 11));
+    else if (a.rfind("--count=", 0) == 0) count = std::atol(a.c_str() + 8);
+    else if (a.rfind("--name=", 0) == 0) name = a.substr(7);
+    else if (a == "--csv") csv = true;
+    else { std::cerr << "usage: statsview [--interval=MS] [--csv] [--count=N] [--name=" << kDefaultName << "]\n"; return 2; }
+  }
+
+  Reader reader;
+  bool waiting = false, headerDone = false;
+  uint64_t lastFrame = 0; int stalled = 0;
+  while (count != 0) {
+    if (!reader.isOpen() && !reader.open(name)) {
+      if (!waiting) std::cerr << "waiting for the game to publish " << name << "...\n";
+      waiting = true;
+    } else {
+      waiting = false;
+      Sample s;
+      if (reader.read(s)) {
+        // The game unlinks the segment on exit; a frame counter that stops moving means it is gone or hung.
+        if (s.frame == lastFrame && ++stalled >= 3) { std::cerr << "no new frames from " << name << ", reattaching\n"; reader.close(); stalled = 0; }
+        else {
+          if (s.frame != lastFrame) stalled = 0;
+          lastFrame = s.frame;
+          if (csv) { if (!headerDone) { printHeader(); headerDone = true; } printCsv(s); }
+          else printText(s);
+          std::fflush(stdout);
+          if (count > 0) --count;
+        }
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+  }
+  return 0;
+}
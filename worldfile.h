@@ -0,0 +1,138 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "mapped_file.h"
+
+// Binary world snapshot (.mkw). A fixed header carries a section table; every
+// section is a packed array of fixed-size little-endian records starting on an
+// 8-byte boundary, so a mapped file is read in place without per-field parsing.
+// Timestamps are stored relative to the save moment and rebased on load.
+namespace worldfile {
+
+constexpr char     kMagic[8]  = { 'M','O','K','I','W','L','D','\0' };
+constexpr uint32_t kVersion   = 1;
+constexpr uint32_t kEndianTag = 0x01020304u;
+
+enum Section : uint32_t { SecTiles, SecPlatforms, SecAvocados, SecKnives, SecPlayer, SecWeb, SecCount };
+
+struct SectionEntry { uint32_t id, recordSize; uint64_t offset, count; };
+struct Header {
+  char     magic[8];
+  uint32_t version, endianTag;
+  uint32_t sectionCount, flags;
+  uint64_t fileSize;
+  SectionEntry sections[SecCount];
+};
+
+enum TileStyle : uint32_t { StyleBlue = 0, StylePurple = 1 };
+struct TileRec    { int32_t x, y, w, h; uint8_t glow[4]; uint32_t style; };
+struct AvocadoRec { float x, y, vx, vy; int32_t w, h, hp; uint32_t flags, splitLeftMS, sinceTouchMS; };
+struct KnifeRec   { float x, y, vx, vy; int32_t w, h, dir; uint32_t ageMS; double spinDPS; };
+struct PlayerRec  {
+  float x, y, velX, velY;
+  int32_t jumpCount, hp, clipKnives, avocadosCollected;
+  uint32_t flags; float webU, webV; uint32_t sinceRechargeMS;
+};
+struct WebRec     { uint32_t state; int32_t reserved; float ax, ay, targetLen, curLen; };   // reserved: written as -1
+
+enum AvocadoFlags : uint32_t { AvoSplit = 1u, AvoCounted = 2u };
+enum PlayerFlags  : uint32_t { PlayerOnGround = 1u, PlayerFacingLeft = 2u, PlayerMoonMode = 4u, PlayerKnivesUnlimited = 8u, PlayerGameOver = 16u };
+
+static_assert(sizeof(SectionEntry) == 24 && sizeof(Header) == 32 + 24 * SecCount, "world header layout");
+static_assert(sizeof(TileRec) == 24 && sizeof(AvocadoRec) == 40 && sizeof(KnifeRec) == 40, "world record layout");
+static_assert(sizeof(PlayerRec) == 48 && sizeof(WebRec) == 24, "world record layout");
+
+constexpr uint64_t align8(uint64_t v) { return (v + 7) & ~uint64_t(7); }
+
+// Collects section arrays and writes them behind a header in one pass.
+class Writer {
+public:
+  template <class T> void put(Section id, const std::vector<T>& recs) {
+    Blob& b = blobs[id]; b.recordSize = sizeof(T); b.count = recs.size();
+    b.bytes.assign((const uint8_t*)recs.data(), (const uint8_t*)(recs.data() + recs.size()));
+  }
+  template <class T> void put(Section id, const T& rec) { put(id, std::vector<T>{ rec }); }
+
+  // Writes to path.tmp and renames over path; std::filesystem::rename replaces an existing
+  // target on every platform (std::rename does not on Windows).
+  bool save(const std::string& path, std::string* err=nullptr) const {
+    Header h{}; std::memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version = kVersion; h.endianTag = kEndianTag; h.sectionCount = SecCount;
+    uint64_t off = align8(sizeof(Header));
+    for (uint32_t i = 0; i < SecCount; ++i) {
+      h.sections[i] = SectionEntry{ i, blobs[i].recordSize, off, blobs[i].count };
+      off = align8(off + blobs[i].bytes.size());
+    }
+    h.fileSize = off;
+    std::string tmp = path + ".tmp";
+    {
+      std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+      if (!out) { if (err) *err = "cannot create " + tmp; return false; }
+      static const char zeros[8] = {};
+      out.write((const char*)&h, sizeof(h));
+      uint64_t at = sizeof(h);
+      for (uint32_t i = 0; i < SecCount; ++i) {
+        out.write(zeros, std::streamsize(h.sections[i].offset - at));
+        out.write((const char*)blobs[i].bytes.data(), std::streamsize(blobs[i].bytes.size()));
+        at = h.sections[i].offset + blobs[i].bytes.size();
+      }
+      out.write(zeros, std::streamsize(h.fileSize - at));
+      if (!out) { if (err) *err = "write failed: " + tmp; return false; }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) { if (err) *err = "rename " + tmp + ": " + ec.message(); std::filesystem::remove(tmp, ec); return false; }
+    return true;
+  }
+
+private:
+  struct Blob { uint32_t recordSize{0}; uint64_t count{0}; std::vector<uint8_t> bytes; };
+  Blob blobs[SecCount];
+};
+
+// Validates a mapped snapshot once; afterwards sections are handed out as raw record spans.
+class Reader {
+public:
+  bool open(const std::string& path, std::string* err=nullptr) {
+    auto fail = [&](const char* why){ if (err) *err = why; file.close(); hdr = nullptr; return false; };
+    if (!file.open(path)) return fail("cannot open file");
+    if (file.size() < sizeof(Header)) return fail("truncated header");
+    hdr = (const Header*)file.data();
+    if (std::memcmp(hdr->magic, kMagic, sizeof(kMagic)) != 0) return fail("bad magic");
+    if (hdr->endianTag != kEndianTag) return fail("endianness mismatch");
+    if (hdr->version != kVersion) return fail("unsupported version");
+    if (hdr->sectionCount < SecCount || hdr->fileSize > file.size()) return fail("bad section table");
+    static const uint32_t sizes[SecCount] = { sizeof(TileRec), sizeof(TileRec), sizeof(AvocadoRec), sizeof(KnifeRec), sizeof(PlayerRec), sizeof(WebRec) };
+    for (uint32_t i = 0; i < SecCount; ++i) {
+      const SectionEntry& s = hdr->sections[i];
+      if (s.count == 0) continue;
+      if (s.recordSize != sizes[i] || (s.offset & 7) != 0) return fail("bad section layout");
+      if (s.offset > file.size() || s.count > (file.size() - s.offset) / s.recordSize) return fail("section out of bounds");
+    }
+    return true;
+  }
+
+  template <class T> const T* records(Section id, size_t& count) const {
+    count = 0;
+    if (!hdr) return nullptr;
+    const SectionEntry& s = hdr->sections[id];
+    if (s.count == 0) return nullptr;
+    count = size_t(s.count);
+    return (const T*)(file.data() + s.offset);
+  }
+
+  bool isOpen() const { return hdr != nullptr; }
+  bool isMapped() const { return file.isMapped(); }
+  size_t bytes() const { return file.size(); }
+
+private:
+  MappedFile file;
+  const Header* hdr = nullptr;
+};
+
+}